@@ -55,6 +55,7 @@ static long opt_optimize = 1;
 static int opt_show_types;
 static int opt_dump_refs;
 static int opt_dump_macros;
+static int opt_unoptimized;
 
 static int64_t elapsed_expand;
 static int64_t elapsed_compile;
@@ -112,6 +113,7 @@ print_usage(int status)
     fprintf(fp, "  -r  --return-vals   return field values for the tree root\n");
     fprintf(fp, "  -0, --optimize=0    do not optimize (check syntax)\n");
     fprintf(fp, "      --types         show field value types\n");
+    fprintf(fp, "      --unoptimized   also print the program compiled without optimizations\n");
     /* NOTE: References are loaded during runtime and dftest only does compilation.
      * Unless some static reference data is hard-coded at compile time during
      * development the --refs option to dftest is useless because it will just
@@ -297,6 +299,7 @@ main(int argc, char **argv)
         { "optimize", ws_required_argument, 0, 1000 },
         { "types",    ws_no_argument,   0, 2000 },
         { "refs",     ws_no_argument,   0, 3000 },
+        { "unoptimized", ws_no_argument, 0, 4000 },
         { NULL,       0,                0,  0   }
     };
     int opt;
@@ -355,6 +358,9 @@ main(int argc, char **argv)
             case 3000:
                 opt_dump_refs = 1;
                 break;
+            case 4000:
+                opt_unoptimized = 1;
+                break;
             case 'v':
                 show_version();
                 exit(EXIT_SUCCESS);
@@ -509,10 +515,29 @@ main(int argc, char **argv)
     if (opt_dump_refs)
         dump_flags |= DF_DUMP_REFERENCES;
 
+    if (opt_unoptimized && opt_optimize > 0) {
+        dfilter_t *df_unopt = NULL;
+        long saved_optimize = opt_optimize;
+        int64_t saved_elapsed = elapsed_compile;
+
+        opt_optimize = 0;
+        if (compile_filter(expanded_text, &df_unopt) && df_unopt != NULL) {
+            printf("Unoptimized:\n");
+            dfilter_dump(stdout, df_unopt, dump_flags);
+            printf("\nOptimized:\n");
+        }
+        dfilter_free(df_unopt);
+        opt_optimize = saved_optimize;
+        elapsed_compile = saved_elapsed;
+    }
+
     dfilter_dump(stdout, df, dump_flags);
 
     print_warnings(df);
 
+    if (dfilter_is_monotonic(df))
+        printf("\nMonotonic: the result can be known before dissection is complete.\n");
+
     if (opt_timer)
         print_elapsed();
 
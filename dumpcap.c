@@ -408,6 +408,12 @@ static bool need_timeout_workaround;
 
 #define WRITER_THREAD_TIMEOUT 100000 /* usecs */
 
+/*
+ * Number of packets written to the capture file after which the parent is
+ * told about them, even if the update interval hasn't elapsed yet.
+ */
+#define SYNC_PIPE_PACKET_BATCH 10000
+
 static void
 dumpcap_log_writer(const char *domain, enum ws_log_level level,
                                    const char *file, long line, const char *func,
@@ -4202,6 +4208,22 @@ handle_npcap_bug(char *adapter_name _U_, char *cap_err_str _U_)
                           "be reported as a Wireshark or Npcap bug.");
 }
 
+/* Flush the capture file and tell the parent process about the packets
+   written to it since it was last told. */
+static void
+capture_loop_sync_packets(void)
+{
+    /* do sync here */
+    fflush(global_ld.pdh);
+
+    /* Send our parent a message saying we've written out
+       "global_ld.inpkts_to_sync_pipe" packets to the capture file. */
+    if (!quiet)
+        report_packet_count(global_ld.inpkts_to_sync_pipe);
+
+    global_ld.inpkts_to_sync_pipe = 0;
+}
+
 /* Do the low-level work of a capture.
    Returns true if it succeeds, false otherwise. */
 static bool
@@ -4408,11 +4430,17 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
             }
         } /* inpkts */
 
-        /* Only update after an interval so as not to overload slow displays.
-         * This also prevents too much context-switching between the dumpcap
-         * and wireshark processes.
-         * XXX: Should we send updates sooner if there have been lots of
-         * packets we haven't notified the parent about, such as on fast links?
+        /* On fast links, don't make the parent wait a whole update interval
+         * for a large batch of packets; it would then fall behind and
+         * dissect them in bursts. Tell it as soon as a batch is written.
+         */
+        if (global_ld.inpkts_to_sync_pipe >= SYNC_PIPE_PACKET_BATCH) {
+            capture_loop_sync_packets();
+        }
+
+        /* Otherwise only update after an interval so as not to overload slow
+         * displays. This also prevents too much context-switching between the
+         * dumpcap and wireshark processes.
          */
 #ifdef _WIN32
         cur_time = GetTickCount64();
@@ -4433,15 +4461,7 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
 #endif
             /* Let the parent process know. */
             if (global_ld.inpkts_to_sync_pipe) {
-                /* do sync here */
-                fflush(global_ld.pdh);
-
-                /* Send our parent a message saying we've written out
-                   "global_ld.inpkts_to_sync_pipe" packets to the capture file. */
-                if (!quiet)
-                    report_packet_count(global_ld.inpkts_to_sync_pipe);
-
-                global_ld.inpkts_to_sync_pipe = 0;
+                capture_loop_sync_packets();
             }
 
             /* check capture duration condition */
@@ -2564,17 +2564,23 @@ main(int argc, char *argv[])
                 const char *comment =
                     (const char*)g_tree_lookup(frames_user_comments, &read_count);
                 if (comment != NULL) {
+                    /* Packets without options may be read without a
+                     * block; read_rec owns the one we add. */
+                    if (read_rec.block == NULL && read_rec.rec_type == REC_TYPE_PACKET)
+                        read_rec.block = wtap_block_create(WTAP_BLOCK_PACKET);
+
                     /* Copy and change rather than modify returned rec */
                     temp_rec = *rec;
+                    temp_rec.block = read_rec.block;
 
                     /* Erase any existing comments before adding the new one */
-                    while (WTAP_OPTTYPE_SUCCESS == wtap_block_remove_nth_option_instance(rec->block, OPT_COMMENT, 0)) {
+                    while (WTAP_OPTTYPE_SUCCESS == wtap_block_remove_nth_option_instance(temp_rec.block, OPT_COMMENT, 0)) {
                         temp_rec.block_was_modified = true;
                         continue;
                     }
 
                     /* The comment is not modified by dumper, cast away. */
-                    wtap_block_add_string_option(rec->block, OPT_COMMENT, (char *)comment, strlen((char *)comment));
+                    wtap_block_add_string_option(temp_rec.block, OPT_COMMENT, (char *)comment, strlen((char *)comment));
                     temp_rec.block_was_modified = true;
                     rec = &temp_rec;
                 } else {
@@ -129,6 +129,12 @@ typedef struct _asn1_ctx_t {
     } u;
   } embedded_pdv;
   struct _rose_ctx_t *rose_ctx;
+  struct {
+      /* Captured data of the tvb PER bits were last read from */
+      tvbuff_t *tvb;
+      const uint8_t *data;
+      unsigned length;
+  } per_bits;
 } asn1_ctx_t;
 
 #define ROSE_CTX_SIGNATURE 0x524F5345  /* "ROSE" */
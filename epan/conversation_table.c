@@ -21,6 +21,8 @@
 
 #include "stat_tap_ui.h"
 
+#include <wsutil/strtoi.h>
+
 struct register_ct {
     bool hide_ports;       /* hide TCP / UDP port columns */
     int proto_id;              /* protocol id (0-indexed) */
@@ -264,6 +266,174 @@ conversation_equal(const void *key1, const void *key2)
     return FALSE;
 }
 
+/*
+ * Approximate top-K mode, used when max_entries is set.
+ *
+ * This is the "Space-Saving" algorithm (Metwally, Agrawal and El Abbadi,
+ * "Efficient Computation of Frequent and Top-k Elements in Data Streams"):
+ * once the table is full, a new entry takes the slot of the entry with the
+ * fewest frames, and inherits that count as its error. A min-heap of slots
+ * keeps that entry at hand. A small count-min sketch of all the entries
+ * seen, evicted or not, often gives a tighter bound on how many frames the
+ * new entry had before it was added.
+ */
+#define TOPK_SKETCH_DEPTH       4
+#define TOPK_SKETCH_MIN_WIDTH   1024
+
+typedef struct _conv_topk_t {
+    unsigned    capacity;
+    unsigned    len;
+    unsigned    *heap;          /* slots, ordered by count */
+    unsigned    *heap_pos;      /* slot -> position in heap */
+    uint64_t    *counts;        /* slot -> frames, including the error */
+    unsigned    sketch_width;
+    uint64_t    *sketch;        /* TOPK_SKETCH_DEPTH rows of sketch_width */
+} conv_topk_t;
+
+static conv_topk_t *
+topk_new(unsigned capacity)
+{
+    conv_topk_t *topk = g_new0(conv_topk_t, 1);
+
+    topk->capacity = capacity;
+    topk->heap = g_new(unsigned, capacity);
+    topk->heap_pos = g_new(unsigned, capacity);
+    topk->counts = g_new(uint64_t, capacity);
+    topk->sketch_width = MAX(TOPK_SKETCH_MIN_WIDTH, capacity * 4);
+    topk->sketch = g_new0(uint64_t, (size_t)TOPK_SKETCH_DEPTH * topk->sketch_width);
+    return topk;
+}
+
+static void
+topk_free(conv_topk_t *topk)
+{
+    if (!topk) {
+        return;
+    }
+    g_free(topk->heap);
+    g_free(topk->heap_pos);
+    g_free(topk->counts);
+    g_free(topk->sketch);
+    g_free(topk);
+}
+
+static void
+topk_swap(conv_topk_t *topk, unsigned a, unsigned b)
+{
+    unsigned slot = topk->heap[a];
+
+    topk->heap[a] = topk->heap[b];
+    topk->heap[b] = slot;
+    topk->heap_pos[topk->heap[a]] = a;
+    topk->heap_pos[topk->heap[b]] = b;
+}
+
+static void
+topk_sift_up(conv_topk_t *topk, unsigned pos)
+{
+    while (pos > 0) {
+        unsigned parent = (pos - 1) / 2;
+        if (topk->counts[topk->heap[parent]] <= topk->counts[topk->heap[pos]]) {
+            break;
+        }
+        topk_swap(topk, pos, parent);
+        pos = parent;
+    }
+}
+
+static void
+topk_sift_down(conv_topk_t *topk, unsigned pos)
+{
+    for (;;) {
+        unsigned smallest = pos;
+        unsigned child = 2 * pos + 1;
+
+        if (child < topk->len && topk->counts[topk->heap[child]] < topk->counts[topk->heap[smallest]]) {
+            smallest = child;
+        }
+        child++;
+        if (child < topk->len && topk->counts[topk->heap[child]] < topk->counts[topk->heap[smallest]]) {
+            smallest = child;
+        }
+        if (smallest == pos) {
+            break;
+        }
+        topk_swap(topk, pos, smallest);
+        pos = smallest;
+    }
+}
+
+/* Adds frames for a key to the sketch and returns the estimated frames
+ * for the key before they were added. */
+static uint64_t
+topk_sketch_add(conv_topk_t *topk, unsigned hash, int num_frames)
+{
+    uint64_t estimate = UINT64_MAX;
+
+    for (unsigned row = 0; row < TOPK_SKETCH_DEPTH; row++) {
+        /* A different multiplicative hash for each row */
+        uint32_t h = (hash ^ (row * 0x7feb352dU)) * 0x9e3779b1U;
+        uint64_t *counter = &topk->sketch[(size_t)row * topk->sketch_width + (h ^ (h >> 16)) % topk->sketch_width];
+
+        estimate = MIN(estimate, *counter);
+        *counter += num_frames;
+    }
+    return estimate;
+}
+
+/* Adds frames to an entry that is in the table. */
+static void
+topk_add(conv_topk_t *topk, unsigned slot, int num_frames)
+{
+    topk->counts[slot] += num_frames;
+    topk_sift_down(topk, topk->heap_pos[slot]);
+}
+
+/* Returns the slot for a new entry, evicting the entry with the fewest
+ * frames if the table is full; *error is set to the frames the new entry
+ * may have missed. */
+static unsigned
+topk_insert(conv_topk_t *topk, uint64_t sketch_estimate, int num_frames, uint64_t *error)
+{
+    unsigned slot;
+
+    if (topk->len < topk->capacity) {
+        slot = topk->len++;
+        *error = 0;
+        topk->counts[slot] = num_frames;
+        topk->heap[topk->len - 1] = slot;
+        topk->heap_pos[slot] = topk->len - 1;
+        topk_sift_up(topk, topk->len - 1);
+        return slot;
+    }
+
+    slot = topk->heap[0];
+    *error = MIN(topk->counts[slot], sketch_estimate);
+    topk->counts[slot] = *error + num_frames;
+    topk_sift_down(topk, 0);
+    return slot;
+}
+
+bool
+conversation_table_parse_topk(const char *arg, unsigned *max_entries, const char **filter)
+{
+    const char *end;
+    uint32_t topk;
+
+    *max_entries = 0;
+    *filter = arg;
+    if (!arg || strncmp(arg, "topk=", 5) != 0) {
+        return true;
+    }
+
+    if (!ws_strtou32(arg + 5, &end, &topk) || topk == 0 || (*end != '\0' && *end != ',')) {
+        return false;
+    }
+    *max_entries = topk;
+    *filter = (*end == ',') ? end + 1 : NULL;
+    return true;
+}
+
 void
 reset_conversation_table_data(conv_hash_t *ch)
 {
@@ -286,8 +456,11 @@ reset_conversation_table_data(conv_hash_t *ch)
         g_hash_table_destroy(ch->hashtable);
     }
 
+    topk_free(ch->topk);
+
     ch->conv_array=NULL;
     ch->hashtable=NULL;
+    ch->topk=NULL;
 }
 
 void reset_endpoint_table_data(conv_hash_t *ch)
@@ -310,8 +483,11 @@ void reset_endpoint_table_data(conv_hash_t *ch)
         g_hash_table_destroy(ch->hashtable);
     }
 
+    topk_free(ch->topk);
+
     ch->conv_array=NULL;
     ch->hashtable=NULL;
+    ch->topk=NULL;
 }
 
 /* For backwards source and binary compatibility */
@@ -664,16 +840,22 @@ add_conversation_table_data_with_conv_id(
 {
     conv_item_t *conv_item = NULL;
     bool is_fwd_direction = false; /* direction of any conversation found */
+    unsigned int conversation_idx = 0;
+    uint64_t sketch_estimate = 0;
 
     /* if we don't have any entries at all yet */
     if (ch->conv_array == NULL) {
-        ch->conv_array = g_array_sized_new(false, false, sizeof(conv_item_t), 10000);
+        ch->conv_array = g_array_sized_new(false, false, sizeof(conv_item_t),
+                                           ch->max_entries ? MIN(ch->max_entries, 10000) : 10000);
 
         ch->hashtable = g_hash_table_new_full(conversation_hash,
                                               conversation_equal, /* key_equal_func */
                                               g_free,             /* key_destroy_func */
                                               NULL);              /* value_destroy_func */
 
+        if (ch->max_entries) {
+            ch->topk = topk_new(ch->max_entries);
+        }
     } else { /* try to find it among the existing known conversations */
         /* first, check in the fwd conversations */
         conv_key_t existing_key;
@@ -685,7 +867,8 @@ add_conversation_table_data_with_conv_id(
         existing_key.port2 = dst_port;
         existing_key.conv_id = conv_id;
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-            conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+            conversation_idx = GPOINTER_TO_UINT(conversation_idx_hash_val);
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
         }
         if (conv_item == NULL) {
             /* then, check in the rev conversations if not found in 'fwd' */
@@ -694,7 +877,8 @@ add_conversation_table_data_with_conv_id(
             existing_key.port1 = dst_port;
             existing_key.port2 = src_port;
             if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-                conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+                conversation_idx = GPOINTER_TO_UINT(conversation_idx_hash_val);
+                conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
             }
         } else {
             /* a conversation was found in this same fwd direction */
@@ -702,12 +886,31 @@ add_conversation_table_data_with_conv_id(
         }
     }
 
+    if (ch->topk) {
+        /* The same in both directions */
+        conv_key_t sketch_key;
+        unsigned sketch_hash;
+
+        sketch_key.addr1 = *src;
+        sketch_key.addr2 = *dst;
+        sketch_key.port1 = src_port;
+        sketch_key.port2 = dst_port;
+        sketch_key.conv_id = conv_id;
+        sketch_hash = conversation_hash(&sketch_key);
+        sketch_key.addr1 = *dst;
+        sketch_key.addr2 = *src;
+        sketch_key.port1 = dst_port;
+        sketch_key.port2 = src_port;
+        sketch_hash ^= conversation_hash(&sketch_key);
+        sketch_estimate = topk_sketch_add(ch->topk, sketch_hash, num_frames);
+    }
+
     /* if we still don't know what conversation this is it has to be a new one
-       and we have to allocate it and append it to the end of the list */
+       and we have to allocate it and append it to the end of the list, or
+       in top-K mode replace the conversation with the fewest frames */
     if (conv_item == NULL) {
         conv_key_t *new_key;
         conv_item_t new_conv_item;
-        unsigned int conversation_idx;
 
         copy_address(&new_conv_item.src_address, src);
         copy_address(&new_conv_item.dst_address, dst);
@@ -724,6 +927,8 @@ add_conversation_table_data_with_conv_id(
         new_conv_item.tx_frames_total = 0;
         new_conv_item.rx_bytes_total = 0;
         new_conv_item.tx_bytes_total = 0;
+        new_conv_item.ext_tcp.flows = 0;
+        new_conv_item.frames_error = 0;
 
         if (ts) {
             memcpy(&new_conv_item.start_time, ts, sizeof(new_conv_item.start_time));
@@ -734,9 +939,28 @@ add_conversation_table_data_with_conv_id(
             nstime_set_unset(&new_conv_item.start_time);
             nstime_set_unset(&new_conv_item.stop_time);
         }
-        g_array_append_val(ch->conv_array, new_conv_item);
-        conversation_idx = ch->conv_array->len - 1;
-        conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+        if (ch->topk) {
+            conversation_idx = topk_insert(ch->topk, sketch_estimate, num_frames, &new_conv_item.frames_error);
+        } else {
+            conversation_idx = ch->conv_array->len;
+        }
+        if (conversation_idx < ch->conv_array->len) {
+            conv_key_t old_key;
+
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+            old_key.addr1 = conv_item->src_address;
+            old_key.addr2 = conv_item->dst_address;
+            old_key.port1 = conv_item->src_port;
+            old_key.port2 = conv_item->dst_port;
+            old_key.conv_id = conv_item->conv_id;
+            g_hash_table_remove(ch->hashtable, &old_key);
+            free_address(&conv_item->src_address);
+            free_address(&conv_item->dst_address);
+            *conv_item = new_conv_item;
+        } else {
+            g_array_append_val(ch->conv_array, new_conv_item);
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+        }
 
         /* ct->conversations address is not a constant but src/dst_address.data are */
         new_key = g_new(conv_key_t, 1);
@@ -761,6 +985,9 @@ add_conversation_table_data_with_conv_id(
          * update an existing conversation
          * update the conversation struct
          */
+        if (ch->topk) {
+            topk_add(ch->topk, conversation_idx, num_frames);
+        }
         if (is_fwd_direction) {
             conv_item->tx_frames_total += num_frames;
             conv_item->tx_bytes_total += num_bytes;
@@ -928,16 +1155,22 @@ void
 add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, bool sender, int num_frames, int num_bytes, et_dissector_info_t *et_info, endpoint_type etype)
 {
     endpoint_item_t *endpoint_item = NULL;
+    unsigned int endpoint_idx = 0;
+    uint64_t sketch_estimate = 0;
 
     /* XXX should be optimized to allocate n extra entries at a time
        instead of just one */
     /* if we don't have any entries at all yet */
     if(ch->conv_array==NULL){
-        ch->conv_array=g_array_sized_new(false, false, sizeof(endpoint_item_t), 10000);
+        ch->conv_array=g_array_sized_new(false, false, sizeof(endpoint_item_t),
+                                         ch->max_entries ? MIN(ch->max_entries, 10000) : 10000);
         ch->hashtable = g_hash_table_new_full(endpoint_hash,
                                               endpoint_match, /* key_equal_func */
                                               g_free,     /* key_destroy_func */
                                               NULL);      /* value_destroy_func */
+        if (ch->max_entries) {
+            ch->topk = topk_new(ch->max_entries);
+        }
     }
     else {
         /* try to find it among the existing known conversations */
@@ -948,16 +1181,25 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
         existing_key.port = port;
 
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &endpoint_idx_hash_val)) {
-            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, GPOINTER_TO_UINT(endpoint_idx_hash_val));
+            endpoint_idx = GPOINTER_TO_UINT(endpoint_idx_hash_val);
+            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
         }
     }
 
+    if (ch->topk) {
+        endpoint_key_t sketch_key;
+
+        copy_address_shallow(&sketch_key.myaddress, addr);
+        sketch_key.port = port;
+        sketch_estimate = topk_sketch_add(ch->topk, endpoint_hash(&sketch_key), num_frames);
+    }
+
     /* if we still don't know what endpoint this is it has to be a new one
-       and we have to allocate it and append it to the end of the list */
+       and we have to allocate it and append it to the end of the list, or
+       in top-K mode replace the endpoint with the fewest frames */
     if(endpoint_item==NULL){
         endpoint_key_t *new_key;
         endpoint_item_t new_endpoint_item;
-        unsigned int endpoint_idx;
 
         copy_address(&new_endpoint_item.myaddress, addr);
         new_endpoint_item.dissector_info = et_info;
@@ -973,16 +1215,34 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
         new_endpoint_item.tx_bytes_total=0;
         new_endpoint_item.modified = true;
         new_endpoint_item.filtered = true;
+        new_endpoint_item.frames_error = 0;
 
-        g_array_append_val(ch->conv_array, new_endpoint_item);
-        endpoint_idx = ch->conv_array->len - 1;
-        endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
+        if (ch->topk) {
+            endpoint_idx = topk_insert(ch->topk, sketch_estimate, num_frames, &new_endpoint_item.frames_error);
+        } else {
+            endpoint_idx = ch->conv_array->len;
+        }
+        if (endpoint_idx < ch->conv_array->len) {
+            endpoint_key_t old_key;
+
+            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
+            copy_address_shallow(&old_key.myaddress, &endpoint_item->myaddress);
+            old_key.port = endpoint_item->port;
+            g_hash_table_remove(ch->hashtable, &old_key);
+            free_address(&endpoint_item->myaddress);
+            *endpoint_item = new_endpoint_item;
+        } else {
+            g_array_append_val(ch->conv_array, new_endpoint_item);
+            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
+        }
 
         /* hl->hosts address is not a constant but address.data is */
         new_key = g_new(endpoint_key_t,1);
         set_address(&new_key->myaddress, endpoint_item->myaddress.type, endpoint_item->myaddress.len, endpoint_item->myaddress.data);
         new_key->port = port;
         g_hash_table_insert(ch->hashtable, new_key, GUINT_TO_POINTER(endpoint_idx));
+    } else if (ch->topk) {
+        topk_add(ch->topk, endpoint_idx, num_frames);
     }
 
     /* if this is a new endpoint we need to initialize the struct */
@@ -47,14 +47,24 @@ typedef enum {
     CONV_DIR_ANY_FROM_B
 } conv_direction_e;
 
+struct _conv_topk_t;
+
 /** Conversation hash + value storage
  * Hash table keys are conv_key_t. Hash table values are indexes into conv_array.
+ *
+ * If max_entries is set before any data is added, at most that many entries
+ * are kept. When the table is full, a new entry replaces the one with the
+ * fewest frames ("Space-Saving" top-K), so the entries with the most frames
+ * are kept in fixed memory. The frames an entry may have missed before it
+ * was added are given by its frames_error.
  */
 typedef struct _conversation_hash_t {
     GHashTable  *hashtable;       /**< conversations hash table */
     GArray      *conv_array;      /**< array of conversation values */
     void        *user_data;       /**< "GUI" specifics (if necessary) */
     unsigned    flags;            /**< flags given to the tap packet */
+    unsigned    max_entries;      /**< maximum number of entries, 0 for no limit */
+    struct _conv_topk_t *topk;    /**< top-K bookkeeping if max_entries is set */
 } conv_hash_t;
 
 /** Key for hash lookups */
@@ -144,6 +154,8 @@ typedef struct _conversation_item_t {
     bool filtered;                  /**< the entry contains only filtered data */
 
     conv_extension_tcp_t ext_tcp;      /**< extension for optional TCP counters */
+
+    uint64_t            frames_error;   /**< upper bound on the frames missed before this entry was added, if max_entries is set */
 } conv_item_t;
 
 /** Endpoint information */
@@ -166,6 +178,7 @@ typedef struct _endpoint_item_t {
     bool modified;      /**< new to redraw the row */
     bool filtered;      /**< the entry contains only filtered data */
 
+    uint64_t frames_error;  /**< upper bound on the frames missed before this entry was added, if max_entries is set */
 } endpoint_item_t;
 
 /* For backwards source compatibility */
@@ -254,6 +267,16 @@ WS_DLL_PUBLIC void conversation_table_iterate_tables(wmem_foreach_func func, voi
  */
 WS_DLL_PUBLIC unsigned conversation_table_get_num(void);
 
+/** Parse an optional "topk=N" option at the start of the argument of a
+ * conversation or endpoint tap, e.g. "topk=1000,ip.addr==10.0.0.1".
+ *
+ * @param arg the tap argument after the protocol name; may be NULL
+ * @param max_entries set to N, or to 0 if there is no option
+ * @param filter set to the rest of the argument, or NULL if there is none
+ * @return false if the option is present but N is not a positive number
+ */
+WS_DLL_PUBLIC bool conversation_table_parse_topk(const char *arg, unsigned *max_entries, const char **filter);
+
 /** Remove all entries from the conversation table.
  *
  * @param ch the table to reset
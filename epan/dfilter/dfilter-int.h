@@ -31,6 +31,11 @@ typedef struct {
 	unsigned idx;
 } df_cell_iter_t;
 
+/* Filter results that can only change in one direction as fields are
+ * added to the tree (see dfilter_apply_partial()). */
+#define DF_MONOTONIC_TRUE	1	/* Once true, stays true. */
+#define DF_MONOTONIC_FALSE	-1	/* Once false, stays false. */
+
 /* Passed back to user */
 struct epan_dfilter {
 	GPtrArray	*insns;
@@ -47,6 +52,7 @@ struct epan_dfilter {
 	/* Used to pass arguments to functions. List of Lists (list of registers). */
 	GSList		*function_stack;
 	GSList		*set_stack;
+	int		monotonicity;
 };
 
 typedef struct {
@@ -92,6 +98,7 @@ typedef struct {
 					allocated from this pool will be freed when the dfwork_t
 					context is destroyed. */
 	GSList		*warnings;
+	int		monotonicity;
 } dfwork_t;
 
 /* Constructor/Destructor prototypes for Lemon Parser */
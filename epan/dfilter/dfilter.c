@@ -501,6 +501,7 @@ dfwork_build(dfwork_t *dfw)
 	dfw->raw_references = NULL;
 	dfilter->warnings = dfw->warnings;
 	dfw->warnings = NULL;
+	dfilter->monotonicity = dfw->monotonicity;
 
 	if (dfw->flags & DF_SAVE_TREE) {
 		ws_assert(tree_str);
@@ -702,6 +703,28 @@ dfilter_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals)
 	return dfvm_apply_full(df, tree, fvals);
 }
 
+bool
+dfilter_apply_partial(dfilter_t *df, proto_tree *tree, bool *result)
+{
+	bool passed;
+
+	if (df->monotonicity == 0)
+		return false;
+
+	passed = dfvm_apply(df, tree);
+	if (passed != (df->monotonicity == DF_MONOTONIC_TRUE))
+		return false;
+
+	*result = passed;
+	return true;
+}
+
+bool
+dfilter_is_monotonic(const dfilter_t *df)
+{
+	return df->monotonicity != 0;
+}
+
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree)
 {
@@ -131,6 +131,18 @@ dfilter_apply(dfilter_t *df, proto_tree *tree);
 bool
 dfilter_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals);
 
+/* Apply compiled dfilter to a tree that is still being dissected.
+ * Returns true, and stores the result in "result", if the result can
+ * no longer change as more fields are added to the tree. */
+bool
+dfilter_apply_partial(dfilter_t *df, proto_tree *tree, bool *result);
+
+/* Returns true if the result of the dfilter can be known before
+ * dissection is complete (see dfilter_apply_partial()). */
+WS_DLL_PUBLIC
+bool
+dfilter_is_monotonic(const dfilter_t *df);
+
 /* Prime a proto_tree using the fields/protocols used in a dfilter. */
 void
 dfilter_prime_proto_tree(const dfilter_t *df, proto_tree *tree);
@@ -0,0 +1,525 @@
+/*
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+#define WS_LOG_DOMAIN LOG_DOMAIN_DFILTER
+
+#include "dfset.h"
+
+#include <wsutil/bits_count_ones.h>
+#include <wsutil/inet_cidr.h>
+#include <wsutil/ws_assert.h>
+
+#define IPV4_MAX_PREFIX	32
+#define IPV6_MAX_PREFIX	128
+
+typedef struct {
+	fvalue_t	*low;
+	fvalue_t	*high;	/* NULL for a single value. */
+} df_set_elem_t;
+
+/* One hash table of masked addresses per prefix length. The lengths
+ * in use are kept in descending order so a lookup only probes the
+ * tables that exist. */
+typedef struct {
+	GHashTable	**tables;
+	uint8_t		*lengths;
+	unsigned	num_lengths;
+	unsigned	count;
+} df_prefix_index_t;
+
+struct _df_set {
+	/* Every element in insertion order. Used when the type of the value
+	 * being tested does not match the type of the set. */
+	GArray		*elements;
+	ftenum_t	ftype;
+	bool		mixed_types;
+	bool		frozen;
+
+	GHashTable	*exact;
+	GArray		*intervals;
+	df_prefix_index_t ipv4;
+	df_prefix_index_t ipv6;
+	GArray		*linear;
+};
+
+df_set_t *
+df_set_new(void)
+{
+	df_set_t *set = g_new0(df_set_t, 1);
+	set->elements = g_array_new(false, false, sizeof(df_set_elem_t));
+	set->ftype = FT_NONE;
+	return set;
+}
+
+static void
+prefix_index_free(df_prefix_index_t *idx, unsigned max_prefix)
+{
+	if (idx->tables == NULL)
+		return;
+	for (unsigned i = 0; i <= max_prefix; i++) {
+		if (idx->tables[i])
+			g_hash_table_destroy(idx->tables[i]);
+	}
+	g_free(idx->tables);
+	g_free(idx->lengths);
+}
+
+void
+df_set_free(df_set_t *set)
+{
+	df_set_elem_t *elem;
+
+	if (set == NULL)
+		return;
+
+	for (unsigned i = 0; i < set->elements->len; i++) {
+		elem = &g_array_index(set->elements, df_set_elem_t, i);
+		fvalue_free(elem->low);
+		if (elem->high)
+			fvalue_free(elem->high);
+	}
+	g_array_free(set->elements, true);
+	if (set->exact)
+		g_hash_table_destroy(set->exact);
+	if (set->intervals)
+		g_array_free(set->intervals, true);
+	if (set->linear)
+		g_array_free(set->linear, true);
+	prefix_index_free(&set->ipv4, IPV4_MAX_PREFIX);
+	prefix_index_free(&set->ipv6, IPV6_MAX_PREFIX);
+	g_free(set);
+}
+
+static void
+set_append(df_set_t *set, fvalue_t *low, fvalue_t *high)
+{
+	df_set_elem_t elem = { low, high };
+	ftenum_t ftype = fvalue_type_ftenum(low);
+
+	ws_assert(!set->frozen);
+
+	if (set->elements->len == 0)
+		set->ftype = ftype;
+	else if (set->ftype != ftype)
+		set->mixed_types = true;
+	if (high && fvalue_type_ftenum(high) != set->ftype)
+		set->mixed_types = true;
+
+	g_array_append_val(set->elements, elem);
+}
+
+void
+df_set_add(df_set_t *set, fvalue_t *fv)
+{
+	set_append(set, fv, NULL);
+}
+
+void
+df_set_add_range(df_set_t *set, fvalue_t *low, fvalue_t *high)
+{
+	set_append(set, low, high);
+}
+
+unsigned
+df_set_size(const df_set_t *set)
+{
+	return set->elements->len;
+}
+
+/*
+ * Exact values.
+ *
+ * Only types for which equality is plain value equality are hashed.
+ * Addresses with a netmask/prefix compare equal to every address in
+ * the network and booleans compare any non-zero values as equal, so
+ * the hash would not be consistent with fvalue_eq().
+ */
+static bool
+ftype_can_hash_exact(ftenum_t ftype)
+{
+	return FT_IS_INTEGER(ftype) || FT_IS_STRING(ftype) ||
+		ftype == FT_ETHER || ftype == FT_BYTES ||
+		ftype == FT_UINT_BYTES || ftype == FT_GUID ||
+		ftype == FT_EUI64;
+}
+
+static unsigned
+set_fvalue_hash(const void *key)
+{
+	return fvalue_hash(key);
+}
+
+static gboolean
+set_fvalue_equal(const void *a, const void *b)
+{
+	return fvalue_equal(a, b);
+}
+
+/*
+ * Intervals.
+ */
+static bool
+ftype_can_sort(ftenum_t ftype)
+{
+	return FT_IS_INTEGER(ftype) || FT_IS_FLOATING(ftype) || FT_IS_TIME(ftype);
+}
+
+static int
+compare_interval_low(const void *_a, const void *_b)
+{
+	const df_set_elem_t *a = _a;
+	const df_set_elem_t *b = _b;
+
+	if (fvalue_lt(a->low, b->low) == FT_TRUE)
+		return -1;
+	if (fvalue_gt(a->low, b->low) == FT_TRUE)
+		return 1;
+	return 0;
+}
+
+/* Sorts the intervals by their lower bound and merges those that
+ * overlap, so that they can be searched with a binary search. */
+static void
+merge_intervals(df_set_t *set)
+{
+	df_set_elem_t *cur, *next;
+	unsigned i, n;
+
+	g_array_sort(set->intervals, compare_interval_low);
+
+	n = 0;
+	for (i = 1; i < set->intervals->len; i++) {
+		cur = &g_array_index(set->intervals, df_set_elem_t, n);
+		next = &g_array_index(set->intervals, df_set_elem_t, i);
+		if (fvalue_le(next->low, cur->high) == FT_TRUE) {
+			if (fvalue_gt(next->high, cur->high) == FT_TRUE)
+				cur->high = next->high;
+		}
+		else {
+			n++;
+			g_array_index(set->intervals, df_set_elem_t, n) = *next;
+		}
+	}
+	if (set->intervals->len > 0)
+		g_array_set_size(set->intervals, n + 1);
+}
+
+static bool
+intervals_contain(const GArray *intervals, const fvalue_t *fv)
+{
+	unsigned lo = 0, hi = intervals->len, mid;
+	const df_set_elem_t *elem;
+
+	/* Find the last interval whose lower bound is <= fv. */
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		elem = &g_array_index(intervals, df_set_elem_t, mid);
+		if (fvalue_le(elem->low, fv) == FT_TRUE)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo == 0)
+		return false;
+	elem = &g_array_index(intervals, df_set_elem_t, lo - 1);
+	return fvalue_le(fv, elem->high) == FT_TRUE;
+}
+
+/*
+ * IPv4/IPv6 networks.
+ */
+static uint32_t
+ipv4_prefix_mask(unsigned len)
+{
+	return len == 0 ? 0 : UINT32_C(0xffffffff) << (IPV4_MAX_PREFIX - len);
+}
+
+static void
+ipv6_apply_prefix(ws_in6_addr *addr, unsigned len)
+{
+	unsigned pos = len / 8;
+
+	if (pos >= sizeof(addr->bytes))
+		return;
+	if (len % 8) {
+		addr->bytes[pos] &= (uint8_t)(0xff << (8 - len % 8));
+		pos++;
+	}
+	memset(&addr->bytes[pos], 0, sizeof(addr->bytes) - pos);
+}
+
+static unsigned
+ipv6_key_hash(const void *key)
+{
+	const uint8_t *bytes = ((const ws_in6_addr *)key)->bytes;
+	unsigned hash = 2166136261U;
+
+	for (unsigned i = 0; i < sizeof(ws_in6_addr); i++) {
+		hash = (hash ^ bytes[i]) * 16777619U;
+	}
+	return hash;
+}
+
+static gboolean
+ipv6_key_equal(const void *a, const void *b)
+{
+	return memcmp(a, b, sizeof(ws_in6_addr)) == 0;
+}
+
+static GHashTable *
+prefix_table(df_prefix_index_t *idx, unsigned len, unsigned max_prefix,
+						bool ipv6)
+{
+	if (idx->tables == NULL) {
+		idx->tables = g_new0(GHashTable *, max_prefix + 1);
+		idx->lengths = g_new0(uint8_t, max_prefix + 1);
+	}
+	if (idx->tables[len] == NULL) {
+		if (ipv6)
+			idx->tables[len] = g_hash_table_new_full(ipv6_key_hash, ipv6_key_equal, g_free, NULL);
+		else
+			idx->tables[len] = g_hash_table_new(g_direct_hash, g_direct_equal);
+	}
+	return idx->tables[len];
+}
+
+static void
+prefix_index_finish(df_prefix_index_t *idx, unsigned max_prefix)
+{
+	if (idx->tables == NULL)
+		return;
+	/* Longest prefix first. */
+	idx->num_lengths = 0;
+	for (unsigned len = max_prefix + 1; len-- > 0; ) {
+		if (idx->tables[len])
+			idx->lengths[idx->num_lengths++] = (uint8_t)len;
+	}
+}
+
+static bool
+ipv4_add(df_set_t *set, fvalue_t *fv)
+{
+	const ipv4_addr_and_mask *ipv4 = fvalue_get_ipv4(fv);
+	unsigned len = ws_count_ones(ipv4->nmask);
+	uint32_t key;
+
+	/* Only contiguous netmasks can be indexed by length. */
+	if (ipv4->nmask != ipv4_prefix_mask(len))
+		return false;
+
+	key = ipv4->addr & ipv4->nmask;
+	g_hash_table_add(prefix_table(&set->ipv4, len, IPV4_MAX_PREFIX, false),
+						GUINT_TO_POINTER(key));
+	set->ipv4.count++;
+	return true;
+}
+
+static bool
+ipv4_contains(const df_prefix_index_t *idx, const ipv4_addr_and_mask *ipv4)
+{
+	unsigned len;
+	uint32_t key;
+
+	for (unsigned i = 0; i < idx->num_lengths; i++) {
+		len = idx->lengths[i];
+		key = ipv4->addr & ipv4_prefix_mask(len);
+		if (g_hash_table_contains(idx->tables[len], GUINT_TO_POINTER(key)))
+			return true;
+	}
+	return false;
+}
+
+static bool
+ipv6_add(df_set_t *set, fvalue_t *fv)
+{
+	const ipv6_addr_and_prefix *ipv6 = fvalue_get_ipv6(fv);
+	unsigned len = MIN(ipv6->prefix, IPV6_MAX_PREFIX);
+	ws_in6_addr *key;
+
+	key = g_new(ws_in6_addr, 1);
+	*key = ipv6->addr;
+	ipv6_apply_prefix(key, len);
+	g_hash_table_add(prefix_table(&set->ipv6, len, IPV6_MAX_PREFIX, true), key);
+	set->ipv6.count++;
+	return true;
+}
+
+static bool
+ipv6_contains(const df_prefix_index_t *idx, const ipv6_addr_and_prefix *ipv6)
+{
+	unsigned len;
+	ws_in6_addr key;
+
+	for (unsigned i = 0; i < idx->num_lengths; i++) {
+		len = idx->lengths[i];
+		key = ipv6->addr;
+		ipv6_apply_prefix(&key, len);
+		if (g_hash_table_contains(idx->tables[len], &key))
+			return true;
+	}
+	return false;
+}
+
+void
+df_set_freeze(df_set_t *set)
+{
+	df_set_elem_t *elem;
+	bool indexed;
+
+	ws_assert(!set->frozen);
+	set->frozen = true;
+
+	if (set->mixed_types) {
+		/* Test everything linearly. */
+		return;
+	}
+
+	for (unsigned i = 0; i < set->elements->len; i++) {
+		elem = &g_array_index(set->elements, df_set_elem_t, i);
+		indexed = false;
+
+		if (elem->high == NULL) {
+			if (set->ftype == FT_IPv4) {
+				indexed = ipv4_add(set, elem->low);
+			}
+			else if (set->ftype == FT_IPv6) {
+				indexed = ipv6_add(set, elem->low);
+			}
+			else if (ftype_can_hash_exact(set->ftype)) {
+				if (set->exact == NULL)
+					set->exact = g_hash_table_new(set_fvalue_hash, set_fvalue_equal);
+				g_hash_table_add(set->exact, elem->low);
+				indexed = true;
+			}
+		}
+		else if (ftype_can_sort(set->ftype)) {
+			if (set->intervals == NULL)
+				set->intervals = g_array_new(false, false, sizeof(df_set_elem_t));
+			g_array_append_val(set->intervals, *elem);
+			indexed = true;
+		}
+
+		if (!indexed) {
+			if (set->linear == NULL)
+				set->linear = g_array_new(false, false, sizeof(df_set_elem_t));
+			g_array_append_val(set->linear, *elem);
+		}
+	}
+
+	if (set->intervals)
+		merge_intervals(set);
+	prefix_index_finish(&set->ipv4, IPV4_MAX_PREFIX);
+	prefix_index_finish(&set->ipv6, IPV6_MAX_PREFIX);
+}
+
+static bool
+elem_contains(const df_set_elem_t *elem, const fvalue_t *fv)
+{
+	if (elem->high) {
+		return fvalue_ge(fv, elem->low) == FT_TRUE &&
+			fvalue_le(fv, elem->high) == FT_TRUE;
+	}
+	return fvalue_eq(fv, elem->low) == FT_TRUE;
+}
+
+static bool
+linear_contains(const GArray *elements, const fvalue_t *fv)
+{
+	if (elements == NULL)
+		return false;
+	for (unsigned i = 0; i < elements->len; i++) {
+		if (elem_contains(&g_array_index(elements, df_set_elem_t, i), fv))
+			return true;
+	}
+	return false;
+}
+
+bool
+df_set_contains(const df_set_t *set, fvalue_t *fv)
+{
+	ws_assert(set->frozen);
+
+	if (set->mixed_types || fvalue_type_ftenum(fv) != set->ftype)
+		return linear_contains(set->elements, fv);
+
+	if (set->ftype == FT_IPv4) {
+		const ipv4_addr_and_mask *ipv4 = fvalue_get_ipv4(fv);
+		/* A value that is itself a network can match a shorter
+		 * prefix in the set; leave that to the generic compare. */
+		if (ipv4->nmask != UINT32_C(0xffffffff))
+			return linear_contains(set->elements, fv);
+		if (ipv4_contains(&set->ipv4, ipv4))
+			return true;
+	}
+	else if (set->ftype == FT_IPv6) {
+		const ipv6_addr_and_prefix *ipv6 = fvalue_get_ipv6(fv);
+		if (ipv6->prefix < IPV6_MAX_PREFIX)
+			return linear_contains(set->elements, fv);
+		if (ipv6_contains(&set->ipv6, ipv6))
+			return true;
+	}
+
+	if (set->exact && g_hash_table_contains(set->exact, fv))
+		return true;
+	if (set->intervals && intervals_contain(set->intervals, fv))
+		return true;
+	return linear_contains(set->linear, fv);
+}
+
+char *
+df_set_tostr(const df_set_t *set)
+{
+	wmem_strbuf_t *buf;
+	const char *sep = "";
+
+	buf = wmem_strbuf_new(NULL, "{");
+	if (set->exact) {
+		wmem_strbuf_append_printf(buf, "%shash(%u)", sep,
+						g_hash_table_size(set->exact));
+		sep = " ";
+	}
+	if (set->intervals) {
+		wmem_strbuf_append_printf(buf, "%sintervals(%u)", sep,
+						set->intervals->len);
+		sep = " ";
+	}
+	if (set->ipv4.count > 0) {
+		wmem_strbuf_append_printf(buf, "%sipv4_prefixes(%u/%u)", sep,
+						set->ipv4.count, set->ipv4.num_lengths);
+		sep = " ";
+	}
+	if (set->ipv6.count > 0) {
+		wmem_strbuf_append_printf(buf, "%sipv6_prefixes(%u/%u)", sep,
+						set->ipv6.count, set->ipv6.num_lengths);
+		sep = " ";
+	}
+	if (set->mixed_types) {
+		wmem_strbuf_append_printf(buf, "%slinear(%u)", sep,
+						set->elements->len);
+	}
+	else if (set->linear) {
+		wmem_strbuf_append_printf(buf, "%slinear(%u)", sep,
+						set->linear->len);
+	}
+	wmem_strbuf_append_c(buf, '}');
+	return wmem_strbuf_finalize(buf);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -0,0 +1,62 @@
+/** @file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 2001 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef DFSET_H
+#define DFSET_H
+
+#include <wireshark.h>
+
+#include <epan/ftypes/ftypes.h>
+
+/*
+ * A set of constant values used by the membership operator ("in").
+ *
+ * Sets whose elements are all literals are compiled once, when the
+ * filter is compiled, instead of being pushed onto the set stack for
+ * every packet. Each element is stored in the most suitable index:
+ *
+ *   - exact values of types with a well-behaved hash are kept in a
+ *     hash table;
+ *   - ranges of ordered types (integers, floats, times) are merged into
+ *     a sorted array of disjoint intervals searched with a binary search;
+ *   - IPv4 and IPv6 addresses and networks are kept in one table per
+ *     prefix length, so a lookup costs one probe per distinct length;
+ *   - anything else is tested linearly, like the set stack does.
+ */
+typedef struct _df_set df_set_t;
+
+df_set_t *
+df_set_new(void);
+
+void
+df_set_free(df_set_t *set);
+
+/* The set takes ownership of the values. */
+void
+df_set_add(df_set_t *set, fvalue_t *fv);
+
+void
+df_set_add_range(df_set_t *set, fvalue_t *low, fvalue_t *high);
+
+/* Builds the lookup indexes. Must be called after the last element
+ * has been added and before the first lookup. */
+void
+df_set_freeze(df_set_t *set);
+
+bool
+df_set_contains(const df_set_t *set, fvalue_t *fv);
+
+unsigned
+df_set_size(const df_set_t *set);
+
+/* Describes the structures chosen for the set, for dftest. */
+char *
+df_set_tostr(const df_set_t *set);
+
+#endif
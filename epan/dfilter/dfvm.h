@@ -15,6 +15,7 @@
 #include "syntax-tree.h"
 #include "drange.h"
 #include "dfunctions.h"
+#include "dfset.h"
 
 #define ASSERT_DFVM_OP_NOT_REACHED(op) \
 	ws_error("Invalid dfvm opcode '%s'.", dfvm_opcode_tostr(op))
@@ -30,6 +31,7 @@ typedef enum {
 	DRANGE,
 	FUNCTION_DEF,
 	PCRE,
+	CONSTANT_SET,
 } dfvm_value_type_t;
 
 typedef struct {
@@ -42,6 +44,7 @@ typedef struct {
 		header_field_info	*hfinfo;
 		df_func_def_t		*funcdef;
 		ws_regex_t		*pcre;
+		df_set_t		*set;
 	} value;
 
 	int ref_count;
@@ -152,6 +155,9 @@ dfvm_value_new_pcre(ws_regex_t *re);
 dfvm_value_t*
 dfvm_value_new_uint(unsigned num);
 
+dfvm_value_t*
+dfvm_value_new_set(df_set_t *set);
+
 void
 dfvm_dump(FILE *f, dfilter_t *df, uint16_t flags);
 
@@ -459,8 +459,18 @@ fixup_jumps(void *data, void *user_data)
 	}
 }
 
-/* Generate the code for the in operator. Pushes set values into a stack
- * and then evaluates membership in a single instruction. */
+static bool
+set_element_is_constant(stnode_t *node1, stnode_t *node2)
+{
+	if (stnode_type_id(node1) != STTYPE_FVALUE)
+		return false;
+	return node2 == NULL || stnode_type_id(node2) == STTYPE_FVALUE;
+}
+
+/* Generate the code for the in operator. Elements that are literals are
+ * compiled into an indexed set when optimizing. The remaining elements
+ * are pushed into a stack at run time. Membership is then evaluated in
+ * a single instruction. */
 static void
 gen_relation_in(dfwork_t *dfw, dfvm_opcode_t op, stmatch_t how,
 				stnode_t *st_arg1, stnode_t *st_arg2)
@@ -471,10 +481,15 @@ gen_relation_in(dfwork_t *dfw, dfvm_opcode_t op, stmatch_t how,
 	dfvm_value_t	*val1, *val2, *val3;
 	stnode_t	*node1, *node2;
 	GSList		*nodelist_head, *nodelist;
+	df_set_t	*set = NULL;
+	bool		need_stack = false;
 
 	/* Create code for the LHS of the relation */
 	val1 = gen_entity(dfw, st_arg1, &jumps);
 
+	if (dfw->flags & DF_OPTIMIZE)
+		set = df_set_new();
+
 	/* Create code to populate the set stack */
 	nodelist_head = nodelist = stnode_steal_data(st_arg2);
 	while (nodelist) {
@@ -483,6 +498,17 @@ gen_relation_in(dfwork_t *dfw, dfvm_opcode_t op, stmatch_t how,
 		node2 = nodelist->data;
 		nodelist = g_slist_next(nodelist);
 
+		if (set && set_element_is_constant(node1, node2)) {
+			if (node2) {
+				df_set_add_range(set, stnode_steal_data(node1),
+							stnode_steal_data(node2));
+			} else {
+				df_set_add(set, stnode_steal_data(node1));
+			}
+			continue;
+		}
+
+		need_stack = true;
 		if (node2) {
 			/* Range element. */
 			val2 = gen_entity(dfw, node1, &node_jumps);
@@ -504,11 +530,20 @@ gen_relation_in(dfwork_t *dfw, dfvm_opcode_t op, stmatch_t how,
 	/* Create code for the set on the RHS of the relation */
 	insn = dfvm_insn_new(select_opcode(op, how));
 	insn->arg1 = dfvm_value_ref(val1);
+	if (set && df_set_size(set) > 0) {
+		df_set_freeze(set);
+		insn->arg2 = dfvm_value_ref(dfvm_value_new_set(set));
+	}
+	else {
+		df_set_free(set);
+	}
 	dfw_append_insn(dfw, insn);
 
 	/* Add instruction to clear the whole stack */
-	insn = dfvm_insn_new(DFVM_SET_CLEAR);
-	dfw_append_insn(dfw, insn);
+	if (need_stack) {
+		insn = dfvm_insn_new(DFVM_SET_CLEAR);
+		dfw_append_insn(dfw, insn);
+	}
 
 	/* Jump here if the LHS entity was not present */
 	g_slist_foreach(jumps, fixup_jumps, dfw);
@@ -865,6 +900,380 @@ gencode(dfwork_t *dfw, stnode_t *st_node)
 }
 
 
+/*
+ * Syntax tree optimizations. These run after the semantic check, when the
+ * types of all the nodes are known, and before code generation.
+ */
+
+static unsigned
+estimate_cost(stnode_t *node);
+
+static unsigned
+estimate_set_cost(stnode_t *node)
+{
+	unsigned cost = 0;
+
+	for (GSList *l = stnode_data(node); l != NULL; l = l->next) {
+		if (l->data)
+			cost += estimate_cost(l->data);
+	}
+	return cost;
+}
+
+/* Rough relative cost of evaluating a node at run time. Constants are
+ * free, each field read is a lookup in the tree, and string searches,
+ * regular expressions and function calls are the most expensive. */
+static unsigned
+estimate_cost(stnode_t *node)
+{
+	stnode_op_t	op;
+	stnode_t	*left, *right;
+	unsigned	cost;
+
+	switch (stnode_type_id(node)) {
+		case STTYPE_FIELD:
+		case STTYPE_REFERENCE:
+			/* Layer filters need to walk the values. */
+			return sttype_field_drange(node) ? 3 : 2;
+		case STTYPE_SLICE:
+			return 1 + estimate_cost(sttype_slice_entity(node));
+		case STTYPE_FUNCTION:
+			cost = 8;
+			for (GSList *l = sttype_function_params(node); l != NULL; l = l->next)
+				cost += estimate_cost(l->data);
+			return cost;
+		case STTYPE_SET:
+			return estimate_set_cost(node);
+		case STTYPE_TEST:
+		case STTYPE_ARITHMETIC:
+			break;
+		default:
+			return 0;
+	}
+
+	sttype_oper_get(node, &op, &left, &right);
+	cost = estimate_cost(left);
+	if (right)
+		cost += estimate_cost(right);
+
+	switch (op) {
+		case STNODE_OP_NOT:
+		case STNODE_OP_AND:
+		case STNODE_OP_OR:
+			return cost;
+		case STNODE_OP_CONTAINS:
+			return cost + 4;
+		case STNODE_OP_MATCHES:
+			return cost + 16;
+		case STNODE_OP_IN:
+		case STNODE_OP_NOT_IN:
+			return cost + 2;
+		default:
+			return cost + 1;
+	}
+}
+
+/* Cost of a node used as a test. A bare field is an existence check,
+ * which doesn't need to load any values. */
+static unsigned
+estimate_test_cost(stnode_t *node)
+{
+	if (stnode_type_id(node) == STTYPE_FIELD)
+		return 1;
+	return estimate_cost(node);
+}
+
+static void
+stnode_swap(stnode_t *a, stnode_t *b)
+{
+	stnode_t tmp = *a;
+	*a = *b;
+	*b = tmp;
+}
+
+static void
+optimize_tree(stnode_t *node);
+
+/* Collects the operands of a chain of the same logical operator, e.g.
+ * "a && (b && c) && d", along with the operator nodes themselves. */
+static void
+collect_operands(stnode_t *node, stnode_op_t op, GPtrArray *operands,
+							GPtrArray *opers)
+{
+	stnode_t	*left, *right;
+
+	if (stnode_type_id(node) == STTYPE_TEST && sttype_oper_get_op(node) == op) {
+		g_ptr_array_add(opers, node);
+		sttype_oper_get(node, NULL, &left, &right);
+		collect_operands(left, op, operands, opers);
+		collect_operands(right, op, operands, opers);
+	}
+	else {
+		g_ptr_array_add(operands, node);
+	}
+}
+
+/* Returns true if node is a chain of the dual operator (|| in a chain of
+ * &&, or the other way around) with one of the operands in seen, i.e.
+ * node is implied by another operand of the chain: A && (A || B) == A. */
+static bool
+is_absorbed(stnode_t *node, stnode_op_t dual, GHashTable *seen)
+{
+	GPtrArray	*operands, *opers;
+	bool		absorbed = false;
+	char		*key;
+
+	if (stnode_type_id(node) != STTYPE_TEST || sttype_oper_get_op(node) != dual)
+		return false;
+
+	operands = g_ptr_array_new();
+	opers = g_ptr_array_new();
+	collect_operands(node, dual, operands, opers);
+	for (unsigned i = 0; i < operands->len && !absorbed; i++) {
+		key = dump_syntax_tree_str(operands->pdata[i]);
+		absorbed = g_hash_table_contains(seen, key);
+		g_free(key);
+	}
+	g_ptr_array_free(operands, true);
+	g_ptr_array_free(opers, true);
+	return absorbed;
+}
+
+/* Logical AND and OR are commutative, idempotent and have no side effects,
+ * so the operands of a chain can be deduplicated and reordered so that the
+ * cheapest tests run first and short-circuit the expensive ones. Operands
+ * absorbed by another one are dropped too.
+ *
+ * Complementary operands (A && !A, A || !A) are left alone, as there is no
+ * constant true or false to replace the chain with, and tests of constants
+ * only are already rejected by the semantic check. */
+static void
+optimize_logical(stnode_t *root, stnode_op_t op)
+{
+	GPtrArray	*operands, *opers;
+	GHashTable	*seen;
+	unsigned	*costs;
+	stnode_t	*node, *acc;
+	stnode_op_t	dual;
+	unsigned	i, j, n, m, cost;
+	char		*key;
+
+	operands = g_ptr_array_new();
+	opers = g_ptr_array_new();
+	collect_operands(root, op, operands, opers);
+	ws_assert(opers->pdata[0] == root);
+
+	/* Detach the operands from the operator nodes. They are put
+	 * back together below. */
+	for (i = 0; i < opers->len; i++) {
+		sttype_oper_set2_args(opers->pdata[i], NULL, NULL);
+	}
+
+	/* Optimize each operand and drop duplicates (A && A == A). */
+	seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	n = 0;
+	for (i = 0; i < operands->len; i++) {
+		node = operands->pdata[i];
+		optimize_tree(node);
+		key = dump_syntax_tree_str(node);
+		if (!g_hash_table_add(seen, key)) {
+			stnode_free(node);
+			continue;
+		}
+		operands->pdata[n++] = node;
+	}
+
+	/* Drop absorbed operands (A && (A || B) == A). An operand can only be
+	 * absorbed by a smaller one, so at least one is left. */
+	dual = (op == STNODE_OP_AND) ? STNODE_OP_OR : STNODE_OP_AND;
+	m = 0;
+	for (i = 0; i < n; i++) {
+		node = operands->pdata[i];
+		if (is_absorbed(node, dual, seen)) {
+			stnode_free(node);
+			continue;
+		}
+		operands->pdata[m++] = node;
+	}
+	n = m;
+	g_hash_table_destroy(seen);
+
+	/* Stable insertion sort by cost. */
+	costs = g_new(unsigned, n);
+	for (i = 0; i < n; i++) {
+		node = operands->pdata[i];
+		cost = estimate_test_cost(node);
+		for (j = i; j > 0 && costs[j - 1] > cost; j--) {
+			operands->pdata[j] = operands->pdata[j - 1];
+			costs[j] = costs[j - 1];
+		}
+		operands->pdata[j] = node;
+		costs[j] = cost;
+	}
+	g_free(costs);
+
+	if (n == 1) {
+		/* Only one operand is left, the root becomes the operand. */
+		node = operands->pdata[0];
+		stnode_swap(root, node);
+		stnode_free(node);
+		for (i = 1; i < opers->len; i++) {
+			stnode_free(opers->pdata[i]);
+		}
+	}
+	else {
+		/* Rebuild the chain, left-associative, reusing the operator
+		 * nodes: opers[1..n-2] and the root, which must remain the
+		 * outermost node. */
+		acc = operands->pdata[0];
+		for (i = 1; i < n; i++) {
+			node = (i == n - 1) ? root : opers->pdata[i];
+			sttype_oper_set2_args(node, acc, operands->pdata[i]);
+			acc = node;
+		}
+		for (i = n - 1; i < opers->len; i++) {
+			stnode_free(opers->pdata[i]);
+		}
+	}
+
+	g_ptr_array_free(operands, true);
+	g_ptr_array_free(opers, true);
+}
+
+static void
+optimize_tree(stnode_t *node)
+{
+	stnode_op_t	op;
+	stnode_t	*left, *right, *inner;
+
+	if (stnode_type_id(node) != STTYPE_TEST)
+		return;
+
+	sttype_oper_get(node, &op, &left, &right);
+
+	switch (op) {
+		case STNODE_OP_NOT:
+			optimize_tree(left);
+			if (stnode_type_id(left) == STTYPE_TEST &&
+					sttype_oper_get_op(left) == STNODE_OP_NOT) {
+				/* Double negation: !!A == A */
+				sttype_oper_get(left, NULL, &inner, NULL);
+				sttype_oper_set1_args(left, NULL);
+				stnode_swap(node, inner);
+				/* Frees both negations. */
+				stnode_free(inner);
+			}
+			break;
+		case STNODE_OP_AND:
+		case STNODE_OP_OR:
+			optimize_logical(node, op);
+			break;
+		default:
+			break;
+	}
+}
+
+/*
+ * Monotonicity analysis. A filter is monotonic if adding fields to the
+ * tree can only change its result from false to true (or only from true
+ * to false, for the negation of a monotonic filter). For those filters the
+ * outcome is known as soon as it flips, before dissection is complete.
+ */
+
+static bool
+entity_is_monotonic(stnode_t *node)
+{
+	stnode_t	*left, *right;
+	header_field_info *hfinfo;
+
+	switch (stnode_type_id(node)) {
+		case STTYPE_FIELD:
+			/* Negative layers count from the end of the tree. */
+			if (sttype_field_drange(node))
+				return false;
+			/* The length of a protocol is set after its
+			 * payload has been dissected. */
+			hfinfo = sttype_field_hfinfo(node);
+			return hfinfo->type != FT_PROTOCOL;
+		case STTYPE_SLICE:
+			return entity_is_monotonic(sttype_slice_entity(node));
+		case STTYPE_FVALUE:
+		case STTYPE_PCRE:
+			return true;
+		case STTYPE_SET:
+			for (GSList *l = stnode_data(node); l != NULL; l = l->next) {
+				if (l->data && !entity_is_monotonic(l->data))
+					return false;
+			}
+			return true;
+		case STTYPE_ARITHMETIC:
+			/* Only if it maps each value of a single field. */
+			sttype_oper_get(node, NULL, &left, &right);
+			if (right == NULL)
+				return entity_is_monotonic(left);
+			if (stnode_type_id(left) == STTYPE_FVALUE)
+				return entity_is_monotonic(right);
+			if (stnode_type_id(right) == STTYPE_FVALUE)
+				return entity_is_monotonic(left);
+			return false;
+		default:
+			/* Functions can aggregate values (count, len, max). */
+			return false;
+	}
+}
+
+/* Returns true if the relation is true when at least one value matches. */
+static bool
+relation_is_any(stnode_op_t op, stmatch_t how)
+{
+	if (how != STNODE_MATCH_DEF)
+		return how == STNODE_MATCH_ANY;
+
+	switch (op) {
+		case STNODE_OP_ALL_EQ:
+		case STNODE_OP_ALL_NE:
+		case STNODE_OP_NOT_IN:
+			return false;
+		default:
+			return true;
+	}
+}
+
+static int
+filter_monotonicity(stnode_t *node)
+{
+	stnode_op_t	op;
+	stnode_t	*left, *right;
+	int		m1, m2;
+
+	if (stnode_type_id(node) == STTYPE_FIELD) {
+		/* Existence test. */
+		return sttype_field_drange(node) ? 0 : DF_MONOTONIC_TRUE;
+	}
+	if (stnode_type_id(node) != STTYPE_TEST)
+		return 0;
+
+	sttype_oper_get(node, &op, &left, &right);
+
+	switch (op) {
+		case STNODE_OP_NOT:
+			return -filter_monotonicity(left);
+		case STNODE_OP_AND:
+		case STNODE_OP_OR:
+			m1 = filter_monotonicity(left);
+			m2 = filter_monotonicity(right);
+			return m1 == m2 ? m1 : 0;
+		default:
+			break;
+	}
+
+	if (!relation_is_any(op, sttype_test_get_match(node)))
+		return 0;
+	if (!entity_is_monotonic(left) || !entity_is_monotonic(right))
+		return 0;
+	return DF_MONOTONIC_TRUE;
+}
+
 static void
 optimize(dfwork_t *dfw)
 {
@@ -925,6 +1334,11 @@ dfw_gencode(dfwork_t *dfw)
 	dfw->loaded_fields = g_hash_table_new(g_direct_hash, g_direct_equal);
 	dfw->loaded_raw_fields = g_hash_table_new(g_direct_hash, g_direct_equal);
 	dfw->interesting_fields = g_hash_table_new(g_int_hash, g_int_equal);
+	if (dfw->flags & DF_OPTIMIZE) {
+		optimize_tree(dfw->st_root);
+	}
+	/* Before gencode(), which steals the layer ranges of the fields. */
+	dfw->monotonicity = filter_monotonicity(dfw->st_root);
 	dfvm_insn_t *insn = dfvm_insn_new(DFVM_RETURN);
 	insn->arg1 = dfvm_value_ref(gencode(dfw, dfw->st_root));
 	dfw_append_insn(dfw, insn);
@@ -4287,6 +4287,7 @@ proto_register_dcm(void)
             &global_dcm_reassemble);
 
     dicom_eo_tap = register_export_object(proto_dcm, dcm_eo_packet, NULL);
+    set_eo_entries_complete(proto_dcm);
 
     register_init_routine(&dcm_init);
 
@@ -882,6 +882,31 @@ typedef struct _dns_conv_info_t {
 
 #define MIN_DNAME_LEN    2              /* minimum domain name length */
 
+/* Names already expanded in the DNS message being dissected, by the offset
+ * of each of their labels, so that a compression pointer to a suffix that
+ * has been seen before doesn't have to be followed label by label again.
+ * Only used while dissect_dns_common() is dissecting the message. */
+typedef struct {
+  const char *name;
+  int         len;
+} dns_name_suffix_t;
+
+typedef struct {
+  tvbuff_t   *tvb;
+  int         dns_data_offset;
+  wmem_map_t *suffixes;                 /* label offset -> dns_name_suffix_t */
+} dns_name_cache_t;
+
+static dns_name_cache_t *dns_name_cache;
+
+/* Labels of a name whose suffixes are cached */
+#define DNS_NAME_CACHE_LABELS 64
+
+/* Expanded names, shared by all the messages in a file, as the same names
+ * are looked up over and over again. The pool stops growing when full. */
+static wmem_map_t *dns_name_pool;
+#define DNS_NAME_POOL_MAX 65536
+
 static const true_false_string tfs_flags_response = {
   "Message is a response",
   "Message is a query"
@@ -1556,10 +1581,33 @@ qname_labels_count(const char* name, int name_len)
     return labels;
 }
 
+/* Returns a copy of an expanded name that lasts at least as long as the
+ * packet, from the name pool if it's in use. The name is buf_len bytes
+ * plus a terminating NUL; that differs from name_len if the name has
+ * bitstring labels, which aren't counted in name_len. */
+static const char *
+dns_name_dup(const char *name, int name_len, int buf_len, bool pooled)
+{
+  char *copy;
+
+  if (pooled && name_len == buf_len && (int)strlen(name) == name_len) {
+    copy = (char *)wmem_map_lookup(dns_name_pool, name);
+    if (copy) {
+      return copy;
+    }
+    if (wmem_map_size(dns_name_pool) < DNS_NAME_POOL_MAX) {
+      copy = wmem_strndup(wmem_file_scope(), name, name_len);
+      wmem_map_insert(dns_name_pool, copy, copy);
+      return copy;
+    }
+  }
+  return (const char *)wmem_memdup(wmem_packet_scope(), name, buf_len + 1);
+}
+
 /* This function returns the number of bytes consumed and the expanded string
  * in *name.
- * The string is allocated with wmem_packet_scope scope and does not need to be freed.
- * it will be automatically freed when the packet has been dissected.
+ * The string lasts at least until the packet has been dissected and must not
+ * be modified or freed.
  */
 static int
 expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
@@ -1572,14 +1620,29 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
   int     component_len;
   int     indir_offset;
   int     maxname;
+  char    buf[MAX_DNAME_LEN];
+  dns_name_cache_t *cache = NULL;
+  int     label_offsets[DNS_NAME_CACHE_LABELS];
+  int     label_starts[DNS_NAME_CACHE_LABELS];
+  int     labels_count    = 0;
+  bool    cacheable       = true;
+  bool    extended_label  = false;
+  bool    suffix_found    = false;
 
   const int min_len = 1;        /* Minimum length of encoded name (for root) */
         /* If we're about to return a value (probably negative) which is less
          * than the minimum length, we're looking at bad data and we're liable
          * to put the dissector into a loop.  Instead we throw an exception */
 
+  /* Suffixes can only be taken from the cache when the name isn't limited
+   * to max_len bytes. */
+  if (dns_name_cache && dns_name_cache->tvb == tvb &&
+      dns_name_cache->dns_data_offset == dns_data_offset && max_len == 0) {
+    cache = dns_name_cache;
+  }
+
   maxname = MAX_DNAME_LEN;
-  np=(char *)wmem_alloc(wmem_packet_scope(), maxname);
+  np=buf;
   *name=np;
   (*name_len) = 0;
 
@@ -1596,6 +1659,13 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
 
       case 0x00:
         /* Label */
+        if (labels_count < DNS_NAME_CACHE_LABELS) {
+          label_offsets[labels_count] = offset - 1;
+          label_starts[labels_count] = (np != *name) ? *name_len + 1 : 0;
+          labels_count++;
+        } else {
+          cacheable = false;
+        }
         if (np != *name) {
           /* Not the first component - put in a '.'. */
           if (maxname > 0) {
@@ -1623,6 +1693,10 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
 
       case 0x40:
         /* Extended label (RFC 2673) */
+        /* What is printed for it isn't counted in name_len, so don't take
+         * suffixes from the cache for the rest of the name either. */
+        cacheable = false;
+        extended_label = true;
         switch (component_len & 0x3f) {
 
           case 0x01:
@@ -1719,14 +1793,54 @@ expand_dns_name(tvbuff_t *tvb, int offset, int max_len, int dns_data_offset,
           return len;
         }
 
+        if (cache && !extended_label) {
+          const dns_name_suffix_t *suffix;
+
+          suffix = (const dns_name_suffix_t *)wmem_map_lookup(cache->suffixes, GINT_TO_POINTER(indir_offset));
+          if (suffix && np == *name) {
+            /* The whole name has been seen before */
+            *name = suffix->name;
+            *name_len = suffix->len;
+            return len;
+          }
+          if (suffix && (np - buf) + 1 + suffix->len <= MAX_DNAME_LEN - 2) {
+            if (suffix->len > 0) {
+              *np++ = '.';
+              memcpy(np, suffix->name, suffix->len);
+              np += suffix->len;
+              *name_len += 1 + suffix->len;
+              maxname = MAX_DNAME_LEN - 1 - (int)(np - buf);
+            }
+            suffix_found = true;
+            break;
+          }
+        }
+
         offset = indir_offset;
         break;   /* now continue processing from there */
     }
+    if (suffix_found) {
+      break;
+    }
   }
 
   // Do we have space for the terminating 0?
   if (maxname > 0) {
     *np = '\0';
+    *name = dns_name_dup(buf, *name_len, (int)(np - buf), cache != NULL);
+    if (cache && cacheable) {
+      for (int i = 0; i < labels_count; i++) {
+        dns_name_suffix_t *suffix;
+
+        if (wmem_map_contains(cache->suffixes, GINT_TO_POINTER(label_offsets[i]))) {
+          continue;
+        }
+        suffix = wmem_new(wmem_packet_scope(), dns_name_suffix_t);
+        suffix->name = *name + label_starts[i];
+        suffix->len = *name_len - label_starts[i];
+        wmem_map_insert(cache->suffixes, GINT_TO_POINTER(label_offsets[i]), suffix);
+      }
+    }
   }
   else {
     *name="<Name too long>";
@@ -4541,7 +4655,13 @@ dissect_dso_data(tvbuff_t *tvb, int offset, packet_info *pinfo _U_, proto_tree *
 }
 
 static void
-dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
+restore_dns_name_cache(void *prev_cache)
+{
+  dns_name_cache = (dns_name_cache_t *)prev_cache;
+}
+
+static void
+dissect_dns_message(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
     enum DnsTransport transport, bool is_mdns, bool is_llmnr)
 {
   int                offset   = (transport == DNS_TRANSPORT_TCP || transport == DNS_TRANSPORT_QUIC) ? 2 : 0;
@@ -4991,6 +5111,24 @@ dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
   }
 }
 
+static void
+dissect_dns_common(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree,
+    enum DnsTransport transport, bool is_mdns, bool is_llmnr)
+{
+  dns_name_cache_t cache;
+
+  /* Cache the names of this message while it is dissected; the names are
+   * all relative to the start of the message. */
+  cache.tvb = tvb;
+  cache.dns_data_offset = (transport == DNS_TRANSPORT_TCP || transport == DNS_TRANSPORT_QUIC) ? 2 : 0;
+  cache.suffixes = wmem_map_new(pinfo->pool, g_direct_hash, g_direct_equal);
+
+  CLEANUP_PUSH(restore_dns_name_cache, dns_name_cache);
+  dns_name_cache = &cache;
+  dissect_dns_message(tvb, pinfo, tree, transport, is_mdns, is_llmnr);
+  CLEANUP_CALL_AND_POP;
+}
+
 static int
 dissect_dns_udp_sctp(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree, void* data _U_)
 {
@@ -7940,6 +8078,8 @@ proto_register_dns(void)
   doq_handle = register_dissector("dns.doq", dissect_dns_doq, proto_dns);
 
   dns_tap = register_tap("dns");
+
+  dns_name_pool = wmem_map_new_autoreset(wmem_epan_scope(), wmem_file_scope(), g_str_hash, g_str_equal);
 }
 
 /*
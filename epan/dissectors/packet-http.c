@@ -35,6 +35,7 @@
 #include <epan/proto_data.h>
 #include <epan/export_object.h>
 #include <epan/exceptions.h>
+#include <epan/header_table.h>
 #include <epan/show_exception.h>
 #include <epan/unit_strings.h>
 #include <glib.h>
@@ -3103,6 +3104,9 @@ static const header_info headers[] = {
 	{ "HTTP2-Settings", &hf_http_http2_settings, HDR_HTTP2_SETTINGS },
 };
 
+/* Perfect hash of the names in headers[] */
+static header_table_t *http_header_table;
+
 /*
  * Look up a header name (assume lower-case header_name).
  */
@@ -3922,16 +3926,7 @@ process_header(tvbuff_t *tvb, int offset, int next_offset,
 static int
 find_header_hf_value(tvbuff_t *tvb, int offset, unsigned header_len)
 {
-	unsigned i;
-
-	for (i = 0; i < array_length(headers); i++) {
-		if (header_len == strlen(headers[i].name) &&
-			tvb_strncaseeql(tvb, offset,
-				    headers[i].name, header_len) == 0)
-			return i;
-	}
-
-	return -1;
+	return header_table_lookup_tvb(http_header_table, tvb, offset, header_len);
 }
 
 /*
@@ -4771,6 +4766,8 @@ proto_register_http(void)
 	expert_http = expert_register_protocol(proto_http);
 	expert_register_field_array(expert_http, ei, array_length(ei));
 
+	http_header_table = HEADER_TABLE_NEW(wmem_epan_scope(), headers, name);
+
 	http_handle = register_dissector("http", dissect_http, proto_http);
 	http_tcp_handle = register_dissector("http-over-tcp", dissect_http_tcp, proto_http);
 	http_tls_handle = register_dissector("http-over-tls", dissect_http_tls, proto_http); /* RFC 2818 */
@@ -4878,6 +4875,7 @@ proto_register_http(void)
 							tcp_port_to_display, follow_tvb_tap_listener,
 							get_tcp_stream_count, NULL);
 	http_eo_tap = register_export_object(proto_http, http_eo_packet, NULL);
+	set_eo_entries_complete(proto_http);
 
 	/* compile patterns, excluding "/" */
 	ws_mempbrk_compile(&pbrk_gen_delims, ":?#[]@");
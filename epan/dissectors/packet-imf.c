@@ -1377,6 +1377,7 @@ proto_register_imf(void)
 
   /* Register for tapping */
   imf_eo_tap = register_export_object(proto_imf, imf_eo_packet, NULL);
+  set_eo_entries_complete(proto_imf);
 
 }
 
@@ -19,6 +19,7 @@
 #include <epan/prefs.h>
 #include <epan/proto_data.h>
 #include <epan/expert.h>
+#include <epan/header_table.h>
 #include <wsutil/strtoi.h>
 #include <wsutil/str_util.h>
 #include <wsutil/array.h>
@@ -88,6 +89,9 @@ static const msrp_header_t msrp_headers[] = {
     { "Authentication-Info"},   /*  15 */
 };
 
+/* Perfect hash of the names in msrp_headers[], except the first */
+static header_table_t *msrp_header_table;
+
 static int hf_header_array[array_length(msrp_headers)];
 
 #define MSRP_FROM_PATH                          1
@@ -250,17 +254,9 @@ show_setup_info(tvbuff_t *tvb, packet_info *pinfo, proto_tree *tree)
 /* Returns index of headers */
 static int msrp_is_known_msrp_header(tvbuff_t *tvb, int offset, unsigned header_len)
 {
-    unsigned i;
+    int i = header_table_lookup_tvb(msrp_header_table, tvb, offset, header_len);
 
-    for (i = 1; i < array_length(msrp_headers); i++) {
-        if (header_len == strlen(msrp_headers[i].name) &&
-            tvb_strncaseeql(tvb, offset, msrp_headers[i].name, header_len) == 0)
-        {
-            return i;
-        }
-    }
-
-    return -1;
+    return i < 0 ? -1 : i + 1;
 }
 
 
@@ -902,6 +898,9 @@ proto_register_msrp(void)
 
     expert_msrp = expert_register_protocol(proto_msrp);
     expert_register_field_array(expert_msrp, ei, array_length(ei));
+
+    msrp_header_table = header_table_new(wmem_epan_scope(), &msrp_headers[1].name,
+                                         array_length(msrp_headers) - 1, sizeof(msrp_header_t));
 }
 
 
@@ -25,6 +25,7 @@ proper helper routines
 #include <epan/asn1.h>
 #include <epan/expert.h>
 #include <wsutil/str_util.h>
+#include <wsutil/pint.h>
 #include "packet-per.h"
 
 void proto_register_per(void);
@@ -127,6 +128,40 @@ add_per_encoded_label(tvbuff_t* tvb, packet_info* pinfo _U_, proto_tree* tree)
 
 #define SEQ_MAX_COMPONENTS 128
 
+/* Reads 1 to 32 bits. The captured data of the tvb is kept in actx, so that
+ * most reads are a single 64-bit load and shift rather than a call to
+ * tvb_get_bits*(); reads beyond the captured data go through
+ * tvb_get_bits32() to throw the usual exception. */
+static inline uint32_t
+per_get_bits(tvbuff_t *tvb, uint32_t bit_offset, int no_of_bits, asn1_ctx_t *actx)
+{
+	uint32_t byte_offset = bit_offset >> 3;
+	uint64_t word;
+
+	if (actx->per_bits.tvb != tvb) {
+		actx->per_bits.tvb = tvb;
+		actx->per_bits.length = tvb_captured_length(tvb);
+		actx->per_bits.data = actx->per_bits.length ? tvb_get_ptr(tvb, 0, actx->per_bits.length) : NULL;
+	}
+
+	if (byte_offset + 8 <= actx->per_bits.length) {
+		word = pntoh64(actx->per_bits.data + byte_offset);
+	} else if (byte_offset < actx->per_bits.length &&
+	           (((bit_offset & 0x07) + no_of_bits + 7) >> 3) <= actx->per_bits.length - byte_offset) {
+		/* Near the end of the data */
+		word = 0;
+		for (uint32_t i = 0; i < 8; i++) {
+			word <<= 8;
+			if (byte_offset + i < actx->per_bits.length) {
+				word |= actx->per_bits.data[byte_offset + i];
+			}
+		}
+	} else {
+		return tvb_get_bits32(tvb, bit_offset, no_of_bits, ENC_BIG_ENDIAN);
+	}
+	return (uint32_t)((word << (bit_offset & 0x07)) >> (64 - no_of_bits));
+}
+
 static void per_check_value(uint32_t value, uint32_t min_len, uint32_t max_len, asn1_ctx_t *actx, proto_item *item, bool is_signed)
 {
 	if ((is_signed == false) && (value > max_len)) {
@@ -307,8 +342,6 @@ dissect_per_length_determinant(tvbuff_t *tvb, uint32_t offset, asn1_ctx_t *actx,
 	uint32_t len;
 	proto_item *pi;
 	int num_bits;
-	int i, bit, str_length, str_index;
-	bool tmp;
 
 	if(!length){
 		length=&len;
@@ -323,56 +356,31 @@ dissect_per_length_determinant(tvbuff_t *tvb, uint32_t offset, asn1_ctx_t *actx,
 		byte=tvb_get_uint8(tvb, offset>>3);
 		offset+=8;
 	}else{
-		char *str;
+		char *str = NULL;
 		uint32_t val;
 
-		val = 0;
-
-		/* prepare the string (max number of bits + quartet separators + prepended space) */
-		str_length = 256+64+1;
-		str=(char *)wmem_alloc(actx->pinfo->pool, str_length+1);
-		str_index = 0;
-
-		str_length = snprintf(str, str_length+1, " ");
-		for(bit=0;bit<((int)(offset&0x07));bit++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
+		val = per_get_bits(tvb, offset, 8, actx);
+		if ((val&0xc0)==0xc0) { /* bits 8 and 7 both 1, so unconstrained */
+			if (!is_fragmented) {
+				*length = 0;
+				offset += 2;
+				actx->created_item = NULL;
+				dissect_per_not_decoded_yet(tree, actx->pinfo, tvb, "10.9 Unconstrained");
+				return offset;
 			}
-			if (str_index < str_length) str[str_index++] = '.';
+			num_bits = 8;
+			*is_fragmented = true;
+		} else if (val&0x80) { /* bit 8 is 1, so not a single byte length */
+			num_bits = 16;
+			val = per_get_bits(tvb, offset, 16, actx);
+		} else {
+			num_bits = 8;
 		}
-		/* read the bits for the int */
-		num_bits = 8;
-		for(i=0;i<num_bits;i++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if(bit&&(!(bit%8))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			bit++;
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &tmp);
-			val<<=1;
-			if(tmp){
-				val|=1;
-				if (str_index < str_length) str[str_index++] = '1';
-				if (i==0) { /* bit 8 is 1, so not a single byte length */
-					num_bits = 16;
-				}
-				else if (i==1 && val==3) { /* bits 8 and 7 both 1, so unconstrained */
-					if (!is_fragmented) {
-						*length = 0;
-						dissect_per_not_decoded_yet(tree, actx->pinfo, tvb, "10.9 Unconstrained");
-						return offset;
-					} else {
-						num_bits = 8;
-						*is_fragmented = true;
-					}
-				}
-			} else {
-				if (str_index < str_length) str[str_index++] = '0';
-			}
+		if (display_internal_per_fields) {
+			str = decode_bits_in_field(actx->pinfo->pool, offset&0x07, num_bits, val, ENC_BIG_ENDIAN);
 		}
-		str[str_index] = '\0'; /* Terminate string */
+		offset += num_bits;
+		actx->created_item = NULL;
 		if(is_fragmented && *is_fragmented==true){
 			*length = val&0x3f;
 			if (*length>4 || *length==0) {
@@ -468,7 +476,7 @@ dissect_per_length_determinant(tvbuff_t *tvb, uint32_t offset, asn1_ctx_t *actx,
 static uint32_t
 dissect_per_normally_small_nonnegative_whole_number(tvbuff_t *tvb, uint32_t offset, asn1_ctx_t *actx, proto_tree *tree, int hf_index, uint32_t *length)
 {
-	bool small_number, length_bit;
+	bool small_number;
 	uint32_t len, length_determinant;
 	proto_item *pi;
 
@@ -480,16 +488,10 @@ DEBUG_ENTRY("dissect_per_normally_small_nonnegative_whole_number");
 	offset=dissect_per_boolean(tvb, offset, actx, tree, hf_per_small_number_bit, &small_number);
 	if (!display_internal_per_fields) proto_item_set_hidden(actx->created_item);
 	if(!small_number){
-		int i;
 		/* 10.6.1 */
-		*length=0;
-		for(i=0;i<6;i++){
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &length_bit);
-			*length<<=1;
-			if (length_bit) {
-				*length|=1;
-			}
-		}
+		*length = per_get_bits(tvb, offset, 6, actx);
+		offset += 6;
+		actx->created_item = NULL;
 		if(hf_index > 0){
 			pi = proto_tree_add_uint(tree, hf_index, tvb, (offset-6)>>3, (offset%8<6)?2:1, *length);
 			if (!display_internal_per_fields) proto_item_set_hidden(pi);
@@ -504,19 +506,19 @@ DEBUG_ENTRY("dissect_per_normally_small_nonnegative_whole_number");
 			*length = 0;
 			break;
 		case 1:
-			*length = tvb_get_bits8(tvb, offset, 8);
+			*length = per_get_bits(tvb, offset, 8, actx);
 			offset += 8;
 			break;
 		case 2:
-			*length = tvb_get_bits16(tvb, offset, 16, ENC_BIG_ENDIAN);
+			*length = per_get_bits(tvb, offset, 16, actx);
 			offset += 16;
 			break;
 		case 3:
-			*length = tvb_get_bits32(tvb, offset, 24, ENC_BIG_ENDIAN);
+			*length = per_get_bits(tvb, offset, 24, actx);
 			offset += 24;
 			break;
 		case 4:
-			*length = tvb_get_bits32(tvb, offset, 32, ENC_BIG_ENDIAN);
+			*length = per_get_bits(tvb, offset, 32, actx);
 			offset += 32;
 			break;
 		default:
@@ -1153,21 +1155,20 @@ dissect_per_relative_oid_str(tvbuff_t *tvb, uint32_t offset, asn1_ctx_t *actx, p
 uint32_t
 dissect_per_boolean(tvbuff_t *tvb, uint32_t offset, asn1_ctx_t *actx, proto_tree *tree, int hf_index, bool *bool_val)
 {
-	uint8_t ch, mask;
+	uint8_t mask;
 	bool value;
 	header_field_info *hfi;
 
 DEBUG_ENTRY("dissect_per_boolean");
 
-	ch=tvb_get_uint8(tvb, offset>>3);
-	mask=1<<(7-(offset&0x07));
-	if(ch&mask){
-		value=1;
-	} else {
-		value=0;
-	}
-	if(hf_index > 0){
+	value = per_get_bits(tvb, offset, 1, actx);
+	if(hf_index > 0 && !(tree && PTREE_DATA(tree)->visible)){
+		/* Nobody will see the bits in the label */
+		actx->created_item = proto_tree_add_boolean(tree, hf_index, tvb, offset>>3, 1, value);
+	} else if(hf_index > 0){
 		char bits[10];
+
+		mask=1<<(7-(offset&0x07));
 		bits[0] = mask&0x80?'0'+value:'.';
 		bits[1] = mask&0x40?'0'+value:'.';
 		bits[2] = mask&0x20?'0'+value:'.';
@@ -1418,7 +1419,7 @@ DEBUG_ENTRY("dissect_per_constrained_integer");
 
 		val_start = (offset)>>3;
 		val_length = length;
-		val = (uint32_t)tvb_get_bits64(tvb,offset,num_bits,ENC_BIG_ENDIAN);
+		val = per_get_bits(tvb, offset, num_bits, actx);
 
 		if (display_internal_per_fields){
 			str = decode_bits_in_field(actx->pinfo->pool, (offset&0x07),num_bits,val,ENC_BIG_ENDIAN);
@@ -1513,7 +1514,6 @@ dissect_per_constrained_integer_64b(tvbuff_t *tvb, uint32_t offset, asn1_ctx_t *
 	nstime_t timeval;
 	header_field_info *hfi;
 	int num_bits;
-	bool tmp;
 
 DEBUG_ENTRY("dissect_per_constrained_integer_64b");
 	if(has_extension){
@@ -1573,8 +1573,7 @@ DEBUG_ENTRY("dissect_per_constrained_integer_64b");
 		 * as a non-negative  binary integer in a bit field as specified in 10.3 with the minimum
 		 * number of bits necessary to represent the range.
 		 */
-		char *str;
-		int i, bit, length, str_length, str_index = 0;
+		int i;
 		uint64_t mask,mask2;
 		/* We only handle 64 bit integers */
 		mask  = UINT64_C(0x8000000000000000);
@@ -1589,53 +1588,28 @@ DEBUG_ENTRY("dissect_per_constrained_integer_64b");
 			i = i-1;
 
 		num_bits = i;
-		length=1;
 		if(range<=2){
 			num_bits=1;
 		}
 
-		/* prepare the string (max number of bits + quartet separators) */
-		str_length = 512+128;
-		str = (char *)wmem_alloc(actx->pinfo->pool, str_length+1);
-		for(bit=0;bit<((int)(offset&0x07));bit++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if (str_index < str_length) str[str_index++] = '.';
-		}
 		/* read the bits for the int */
-		for(i=0;i<num_bits;i++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if(bit&&(!(bit%8))){
-				length+=1;
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			bit++;
-			offset=dissect_per_boolean(tvb, offset, actx, tree, -1, &tmp);
-			val<<=1;
-			if(tmp){
-				val|=1;
-				if (str_index < str_length) str[str_index++] = '1';
-			} else {
-				if (str_index < str_length) str[str_index++] = '0';
-			}
-		}
-		for(;bit%8;bit++){
-			if(bit&&(!(bit%4))){
-				if (str_index < str_length) str[str_index++] = ' ';
-			}
-			if (str_index < str_length) str[str_index++] = '.';
+		if (num_bits > 32) {
+			val = (uint64_t)per_get_bits(tvb, offset, num_bits - 32, actx) << 32;
+			val |= per_get_bits(tvb, offset + num_bits - 32, 32, actx);
+		} else {
+			val = per_get_bits(tvb, offset, num_bits, actx);
 		}
-		str[str_index] = '\0'; /* Terminate string */
-		val_start = (offset-num_bits)>>3; val_length = length;
-		val+=min;
+		actx->created_item = NULL;
+		val_start = offset>>3; val_length = ((offset&0x07) + num_bits + 7) >> 3;
 		if (display_internal_per_fields) {
+			char *str = decode_bits_in_field(actx->pinfo->pool, offset&0x07, num_bits, val, ENC_BIG_ENDIAN);
+
 			proto_tree_add_uint64(tree, hf_per_internal_range, tvb, val_start, val_length, range);
 			proto_tree_add_uint(tree, hf_per_internal_num_bits, tvb, val_start,val_length, num_bits);
-			proto_tree_add_uint64_format_value(tree, hf_per_internal_value, tvb, val_start, val_length, val, "%s decimal value: %" PRIu64, str, val);
+			proto_tree_add_uint64_format_value(tree, hf_per_internal_value, tvb, val_start, val_length, val+min, "%s decimal value: %" PRIu64, str, val+min);
 		}
+		offset += num_bits;
+		val+=min;
 	} else if(range==256){
 		/* 10.5.7.2 */
 
@@ -1670,7 +1644,7 @@ DEBUG_ENTRY("dissect_per_constrained_integer_64b");
 		}else{
 			n_bits=2;
 		}
-		num_bytes =tvb_get_bits8(tvb, offset, n_bits);
+		num_bytes = per_get_bits(tvb, offset, n_bits, actx);
 		num_bytes++;  /* lower bound for length determinant is 1 */
 		if (display_internal_per_fields){
 			int_item = proto_tree_add_bits_item(tree, hf_per_const_int_len, tvb, offset,n_bits, ENC_BIG_ENDIAN);
@@ -1978,7 +1952,7 @@ DEBUG_ENTRY("dissect_per_sequence");
 	memset(optional_mask, 0, sizeof(optional_mask));
 	for(i=0;i<num_opts;i++){
 		offset=dissect_per_boolean(tvb, offset, actx, tree, hf_per_optional_field_bit, &optional_field_flag);
-		if (tree) {
+		if (tree && PTREE_DATA(tree)->visible) {
 			proto_item_append_text(actx->created_item, " (%s %s present)",
 				index_get_optional_name(sequence, i), optional_field_flag?"is":"is NOT");
 		}
@@ -2045,7 +2019,7 @@ DEBUG_ENTRY("dissect_per_sequence");
 		extension_mask=0;
 		for(i=0;i<num_extensions;i++){
 			offset=dissect_per_boolean(tvb, offset, actx, tree, hf_per_extension_present_bit, &extension_bit);
-			if (tree) {
+			if (tree && PTREE_DATA(tree)->visible) {
 				proto_item_append_text(actx->created_item, " (%s %s present)",
 					index_get_extension_name(sequence, i), extension_bit?"is":"is NOT");
 			}
@@ -2143,7 +2117,7 @@ DEBUG_ENTRY("dissect_per_sequence_eag");
 	memset(optional_mask, 0, sizeof(optional_mask));
 	for(i=0;i<num_opts;i++){
 		offset=dissect_per_boolean(tvb, offset, actx, tree, hf_per_optional_field_bit, &optional_field_flag);
-		if (tree) {
+		if (tree && PTREE_DATA(tree)->visible) {
 			proto_item_append_text(actx->created_item, " (%s %s present)",
 				index_get_optional_name(sequence, i), optional_field_flag?"is":"is NOT");
 		}
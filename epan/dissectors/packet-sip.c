@@ -26,6 +26,7 @@
 
 #include <epan/exported_pdu.h>
 #include <epan/expert.h>
+#include <epan/header_table.h>
 #include <epan/prefs.h>
 #include <epan/req_resp_hdrs.h>
 #include <epan/stat_tap_ui.h>
@@ -1168,7 +1169,10 @@ static sip_info_value_t *stat_info;
  ****************************************************************************/
 
 static GHashTable *sip_hash;           /* Hash table */
-static GHashTable *sip_headers_hash;     /* Hash table */
+
+/* Perfect hashes of the names and compact names in sip_headers[], except the first */
+static header_table_t *sip_header_table;
+static header_table_t *sip_compact_header_table;
 
 /* Types for hash table keys and values */
 #define MAX_CALL_ID_SIZE 128
@@ -1243,24 +1247,13 @@ static int sip_equal(const void *v, const void *v2)
 static void
 sip_init_protocol(void)
 {
-    unsigned i;
-    char *value_copy;
     sip_hash = g_hash_table_new(g_str_hash , sip_equal);
-
-    /* Hash table for quick lookup of SIP headers names to hf entry (POS_x) */
-    sip_headers_hash = g_hash_table_new(g_str_hash , g_str_equal);
-    for (i = 1; i < array_length(sip_headers); i++){
-        value_copy = wmem_strdup(wmem_file_scope(), sip_headers[i].name);
-        ascii_strdown_inplace(value_copy);
-        g_hash_table_insert(sip_headers_hash, (void *)value_copy, GINT_TO_POINTER(i));
-    }
 }
 
 static void
 sip_cleanup_protocol(void)
 {
      g_hash_table_destroy(sip_hash);
-     g_hash_table_destroy(sip_headers_hash);
 }
 
 /* Call the export PDU tap with relevant data */
@@ -5120,24 +5113,16 @@ static bool sip_is_known_request(tvbuff_t *tvb, int meth_offset,
  */
 static int sip_is_known_sip_header(char *header_name, unsigned header_len)
 {
-    unsigned pos;
+    int pos;
 
     /* Compact name is one character long */
     if(header_len>1){
-        pos = GPOINTER_TO_UINT(g_hash_table_lookup(sip_headers_hash, header_name));
-        if (pos!=0)
-            return pos;
-    }
-
-    /* Look for compact name match */
-    for (pos = 1; pos < array_length(sip_headers); pos++) {
-        if (sip_headers[pos].compact_name != NULL &&
-                header_len == strlen(sip_headers[pos].compact_name) &&
-                g_ascii_strncasecmp(header_name, sip_headers[pos].compact_name, header_len) == 0)
-            return pos;
+        pos = header_table_lookup(sip_header_table, header_name, header_len);
+    } else {
+        pos = header_table_lookup(sip_compact_header_table, header_name, header_len);
     }
 
-    return -1;
+    return pos < 0 ? -1 : pos + 1;
 }
 
 /*
@@ -7590,6 +7575,11 @@ void proto_register_sip(void)
     expert_register_field_array(expert_sip, ei, array_length(ei));
     proto_register_subtree_array(ett_raw, array_length(ett_raw));
 
+    sip_header_table = header_table_new(wmem_epan_scope(), &sip_headers[1].name,
+                                        array_length(sip_headers) - 1, sizeof(sip_header_t));
+    sip_compact_header_table = header_table_new(wmem_epan_scope(), &sip_headers[1].compact_name,
+                                                array_length(sip_headers) - 1, sizeof(sip_header_t));
+
     /* Register raw_sip field(s) */
     proto_register_field_array(proto_raw_sip, raw_hf, array_length(raw_hf));
 
@@ -570,6 +570,7 @@ epan_dissect_init(epan_dissect_t *edt, epan_t *session, const bool create_proto_
 	}
 	else {
 		edt->pi.pool = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+		wmem_allocator_set_name(edt->pi.pool, "pinfo");
 	}
 
 	if (create_proto_tree) {
@@ -595,7 +596,7 @@ epan_dissect_reset(epan_dissect_t *edt)
 
 	wtap_block_unref(edt->pi.rec->block);
 
-	g_slist_free(edt->pi.proto_data);
+	g_free(edt->pi.proto_data);
 
 	/* Free the data sources list. */
 	free_data_sources(&edt->pi);
@@ -705,7 +706,7 @@ epan_dissect_cleanup(epan_dissect_t* edt)
 
 	g_slist_foreach(epan_plugins, epan_plugin_dissect_cleanup, edt);
 
-	g_slist_free(edt->pi.proto_data);
+	g_free(edt->pi.proto_data);
 
 	/* Free the data sources list. */
 	free_data_sources(&edt->pi);
@@ -741,6 +742,18 @@ epan_dissect_prime_with_dfilter(epan_dissect_t *edt, const dfilter_t* dfcode)
 	dfilter_prime_proto_tree(dfcode, edt->tree);
 }
 
+void
+epan_dissect_set_early_exit(epan_dissect_t *edt, dfilter_t *dfcode)
+{
+	if (edt->tree == NULL)
+		return;
+
+	if (dfcode != NULL && !dfilter_is_monotonic(dfcode))
+		dfcode = NULL;
+
+	PTREE_DATA(edt->tree)->early_exit_dfilter = dfcode;
+}
+
 void
 epan_dissect_prime_with_hfid(epan_dissect_t *edt, int hfid)
 {
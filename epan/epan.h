@@ -231,6 +231,17 @@ WS_DLL_PUBLIC
 void
 epan_dissect_prime_with_dfilter(epan_dissect_t *edt, const struct epan_dfilter *dfcode);
 
+/** Stop calling subdissectors as soon as the outcome of a dfilter is known
+ * for the packet being dissected. The dfilter must also be primed with
+ * epan_dissect_prime_with_dfilter(). Only useful when nothing but the
+ * filter result is needed; the tree, columns and taps are incomplete for
+ * packets where dissection stopped early. Only frames that have already
+ * been dissected once stop early, so that the state kept across packets
+ * is built from complete dissections. Pass NULL to disable. */
+WS_DLL_PUBLIC
+void
+epan_dissect_set_early_exit(epan_dissect_t *edt, struct epan_dfilter *dfcode);
+
 /** Prime an epan_dissect_t's proto_tree with a field/protocol specified by its hfid */
 WS_DLL_PUBLIC
 void
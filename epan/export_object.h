@@ -90,6 +90,22 @@ WS_DLL_PUBLIC tap_packet_cb get_eo_packet_func(register_eo_t* eo);
  */
 WS_DLL_PUBLIC export_object_gui_reset_cb get_eo_reset_func(register_eo_t* eo);
 
+/** Declare that the taps of an Export Object add each entry once it is
+ * complete, and never retrieve it again with get_entry. A UI can then
+ * save the payload of an entry and free it as soon as it is added,
+ * instead of keeping every entry until the end.
+ *
+ * @param proto_id protocol id passed to register_export_object
+ */
+WS_DLL_PUBLIC void set_eo_entries_complete(const int proto_id);
+
+/** Get whether the entries of an Export Object are complete when added
+ *
+ * @param eo Registered Export Object
+ * @return true if set_eo_entries_complete was called for it
+ */
+WS_DLL_PUBLIC bool get_eo_entries_complete(register_eo_t* eo);
+
 /** Get Export Object by its protocol filter name
  *
  * @param name protocol filter name to fetch.
@@ -11,6 +11,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/epan.h>
@@ -20,6 +22,15 @@
 #include <wiretap/wtap.h>
 #include <wsutil/ws_assert.h>
 
+/* The frames a frame depends on, in ascending order. One allocation per
+ * frame, and 4 bytes per dependency; a frame holding a PDU reassembled
+ * from thousands of segments has thousands of them. */
+struct _frame_dependencies {
+  unsigned count;
+  unsigned size;
+  uint32_t frames[];
+};
+
 #define COMPARE_FRAME_NUM()     ((fdata1->num < fdata2->num) ? -1 : \
                                  (fdata1->num > fdata2->num) ? 1 : \
                                  0)
@@ -309,12 +320,12 @@ frame_data_reset(frame_data *fdata)
   fdata->visited = 0;
 
   if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
+    g_free(fdata->pfd);
     fdata->pfd = NULL;
   }
 
   if (fdata->dependent_frames) {
-    g_hash_table_destroy(fdata->dependent_frames);
+    g_free(fdata->dependent_frames);
     fdata->dependent_frames = NULL;
   }
 }
@@ -323,16 +334,70 @@ void
 frame_data_destroy(frame_data *fdata)
 {
   if (fdata->pfd) {
-    g_slist_free(fdata->pfd);
+    g_free(fdata->pfd);
     fdata->pfd = NULL;
   }
 
   if (fdata->dependent_frames) {
-    g_hash_table_destroy(fdata->dependent_frames);
+    g_free(fdata->dependent_frames);
     fdata->dependent_frames = NULL;
   }
 }
 
+void
+frame_data_add_dependency(frame_data *fdata, uint32_t frame_num)
+{
+  struct _frame_dependencies *deps = fdata->dependent_frames;
+  unsigned lo, hi;
+
+  /* Dissectors usually add the frames in order, so check the end first. */
+  if (deps && deps->count > 0 && deps->frames[deps->count - 1] < frame_num) {
+    lo = deps->count;
+  } else {
+    lo = 0;
+    hi = deps ? deps->count : 0;
+    while (lo < hi) {
+      unsigned mid = lo + (hi - lo) / 2;
+      if (deps->frames[mid] < frame_num) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (deps && lo < deps->count && deps->frames[lo] == frame_num) {
+      return;
+    }
+  }
+
+  if (!deps || deps->count == deps->size) {
+    unsigned size = deps ? deps->size * 2 : 4;
+    deps = (struct _frame_dependencies *)g_realloc(deps,
+        sizeof(struct _frame_dependencies) + size * sizeof(uint32_t));
+    if (!fdata->dependent_frames) {
+      deps->count = 0;
+    }
+    deps->size = size;
+    fdata->dependent_frames = deps;
+  }
+
+  if (lo < deps->count) {
+    memmove(&deps->frames[lo + 1], &deps->frames[lo], (deps->count - lo) * sizeof(uint32_t));
+  }
+  deps->frames[lo] = frame_num;
+  deps->count++;
+}
+
+unsigned
+frame_data_get_dependencies(const frame_data *fdata, const uint32_t **frames)
+{
+  if (!fdata->dependent_frames) {
+    *frames = NULL;
+    return 0;
+  }
+  *frames = fdata->dependent_frames->frames;
+  return fdata->dependent_frames->count;
+}
+
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
  *
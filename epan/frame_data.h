@@ -59,6 +59,8 @@ typedef enum {
    fields within the first 16 or 32 bytes, so they all fit in a cache
    line? */
 struct _color_filter; /* Forward */
+struct _proto_data_list; /* Forward */
+struct _frame_dependencies; /* Forward */
 DIAG_OFF_PEDANTIC
 typedef struct _frame_data {
   uint32_t     num;          /**< Frame number */
@@ -69,8 +71,8 @@ typedef struct _frame_data {
   /* These two are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
      LLP64 (64-bit Windows) platforms.  Put them here, one after the
      other, so they don't require padding between them. */
-  GSList      *pfd;          /**< Per frame proto data */
-  GHashTable  *dependent_frames;     /**< A hash table of frames which this one depends on */
+  struct _proto_data_list *pfd; /**< Per frame proto data */
+  struct _frame_dependencies *dependent_frames; /**< Frames which this one depends on */
   const struct _color_filter *color_filter;  /**< Per-packet matching color_filter_t object */
   uint8_t      tcp_snd_manual_analysis;   /**< TCP SEQ Analysis Overriding, 0 = none, 1 = OOO, 2 = RET , 3 = Fast RET, 4 = Spurious RET  */
   /* Keep the bitfields below to 24 bits, so this plus the previous field
@@ -118,6 +120,22 @@ WS_DLL_PUBLIC void frame_data_set_before_dissect(frame_data *fdata,
 WS_DLL_PUBLIC void frame_data_set_after_dissect(frame_data *fdata,
                 uint32_t *cum_bytes);
 
+/**
+ * Records that a frame depends on another frame, e.g. because the other
+ * frame holds a fragment of a PDU reassembled in this one. Frames are
+ * assumed not to depend on future frames.
+ */
+WS_DLL_PUBLIC void frame_data_add_dependency(frame_data *fdata, uint32_t frame_num);
+
+/**
+ * Gets the frames which a frame depends on, in ascending order.
+ *
+ * @param fdata The frame.
+ * @param frames Set to the frame numbers, or to NULL if there are none.
+ * @return The number of frames.
+ */
+WS_DLL_PUBLIC unsigned frame_data_get_dependencies(const frame_data *fdata, const uint32_t **frames);
+
 /** @} */
 
 #ifdef __cplusplus
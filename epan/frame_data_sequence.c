@@ -315,24 +315,43 @@ free_frame_data_sequence(frame_data_sequence *fds)
 }
 
 void
-find_and_mark_frame_depended_upon(void *key, void *value _U_, void *user_data)
+frame_data_sequence_mark_depended_upon(frame_data_sequence *fds, frame_data *fdata)
 {
-  frame_data   *dependent_fd;
-  uint32_t      dependent_frame = GPOINTER_TO_UINT(key);
-  frame_data_sequence *frames   = (frame_data_sequence *)user_data;
-
-  if (dependent_frame && frames) {
-    dependent_fd = frame_data_sequence_find(frames, dependent_frame);
-    /* Don't recurse for packets we've already marked. Note we assume that no
-     * packet depends on a future packet; we assume that in other places too.
+  const uint32_t *deps;
+  unsigned count;
+  GArray *pending;
+
+  count = frame_data_get_dependencies(fdata, &deps);
+  if (count == 0 || !fds) {
+    return;
+  }
+
+  /* Walk the dependencies with an explicit stack rather than recursion;
+   * e.g. a long TCP stream can be a chain of millions of frames. */
+  pending = g_array_sized_new(false, false, sizeof(uint32_t), count);
+  g_array_append_vals(pending, deps, count);
+  while (pending->len > 0) {
+    uint32_t dependent_frame = g_array_index(pending, uint32_t, pending->len - 1);
+    frame_data *dependent_fd;
+
+    g_array_set_size(pending, pending->len - 1);
+    if (!dependent_frame) {
+      continue;
+    }
+    dependent_fd = frame_data_sequence_find(fds, dependent_frame);
+    /* Don't descend into packets we've already marked. Note we assume that
+     * no packet depends on a future packet; we assume that in other places
+     * too.
      */
     if (!(dependent_fd->dependent_of_displayed || dependent_fd->passed_dfilter)) {
       dependent_fd->dependent_of_displayed = 1;
-      if (dependent_fd->dependent_frames) {
-        g_hash_table_foreach(dependent_fd->dependent_frames, find_and_mark_frame_depended_upon, frames);
+      count = frame_data_get_dependencies(dependent_fd, &deps);
+      if (count > 0) {
+        g_array_append_vals(pending, deps, count);
       }
     }
   }
+  g_array_free(pending, true);
 }
 
 /*
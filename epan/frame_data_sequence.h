@@ -33,7 +33,12 @@ WS_DLL_PUBLIC frame_data *frame_data_sequence_find(frame_data_sequence *fds,
  */
 WS_DLL_PUBLIC void free_frame_data_sequence(frame_data_sequence *fds);
 
-WS_DLL_PUBLIC void find_and_mark_frame_depended_upon(void *key, void *value, void *user_data);
+/*
+ * Mark the frames which a frame depends on, and the frames which they
+ * depend on in turn, as depended upon by a displayed frame.
+ */
+WS_DLL_PUBLIC void frame_data_sequence_mark_depended_upon(frame_data_sequence *fds,
+    frame_data *fdata);
 
 
 #ifdef __cplusplus
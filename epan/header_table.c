@@ -0,0 +1,145 @@
+/* header_table.c
+ * Case-insensitive lookup of protocol header names
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#include "config.h"
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "header_table.h"
+
+typedef struct {
+    const char *name;           /* NULL if the slot is empty */
+    size_t      len;
+    int         index;
+} header_slot_t;
+
+struct _header_table {
+    uint32_t       seed;
+    uint32_t       mask;        /* number of slots - 1 */
+    header_slot_t *slots;
+};
+
+/* Seeds tried for a number of slots before it is doubled */
+#define HEADER_TABLE_MAX_SEEDS  256
+
+static inline uint8_t
+header_fold(uint8_t c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+/* FNV-1a of the lower-case name, so that names differing only by case
+ * hash alike. */
+static inline uint32_t
+header_hash(uint32_t seed, const char *name, size_t len)
+{
+    uint32_t hash = 2166136261U ^ seed ^ (uint32_t)len;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= header_fold(name[i]);
+        hash *= 16777619U;
+    }
+    return hash ^ (hash >> 15);
+}
+
+/* Tries to place every name in its own slot with the table's seed and
+ * number of slots. */
+static bool
+header_table_fill(header_table_t *table, const char * const *names, unsigned count)
+{
+    memset(table->slots, 0, (table->mask + 1) * sizeof(header_slot_t));
+
+    for (unsigned i = 0; i < count; i++) {
+        header_slot_t *slot;
+        size_t len;
+
+        if (names[i] == NULL) {
+            continue;
+        }
+        len = strlen(names[i]);
+        slot = &table->slots[header_hash(table->seed, names[i], len) & table->mask];
+        if (slot->name != NULL) {
+            if (slot->len == len && g_ascii_strncasecmp(slot->name, names[i], len) == 0) {
+                /* A duplicate; the first one wins, as with a linear search. */
+                continue;
+            }
+            return false;
+        }
+        slot->name = names[i];
+        slot->len = len;
+        slot->index = i;
+    }
+    return true;
+}
+
+header_table_t *
+header_table_new(wmem_allocator_t *scope, const char * const *first_name, unsigned count, size_t stride)
+{
+    header_table_t *table = wmem_new(scope, header_table_t);
+    const char **names = g_new(const char *, count);
+    uint32_t nslots = 8;
+
+    for (unsigned i = 0; i < count; i++) {
+        names[i] = *(const char * const *)((const char *)first_name + i * stride);
+    }
+
+    /* Every name needs a slot of its own, and a seed places n names in m
+     * slots without a collision with a probability of about
+     * exp(-n^2 / 2m), so the table has to grow with the square of the
+     * number of names: the 60 to 140 names of the text protocols end up
+     * in tables 8 to 16 times as large. Start at 4 times the count rather
+     * than trying all the seeds on tables that can hardly ever work. */
+    while (nslots < 4 * count) {
+        nslots *= 2;
+    }
+    table->slots = NULL;
+    for (;;) {
+        table->mask = nslots - 1;
+        table->slots = (header_slot_t *)wmem_realloc(scope, table->slots, nslots * sizeof(header_slot_t));
+        for (table->seed = 0; table->seed < HEADER_TABLE_MAX_SEEDS; table->seed++) {
+            if (header_table_fill(table, names, count)) {
+                g_free(names);
+                return table;
+            }
+        }
+        nslots *= 2;
+    }
+}
+
+int
+header_table_lookup(const header_table_t *table, const char *name, size_t len)
+{
+    const header_slot_t *slot = &table->slots[header_hash(table->seed, name, len) & table->mask];
+
+    if (slot->name != NULL && slot->len == len && g_ascii_strncasecmp(slot->name, name, len) == 0) {
+        return slot->index;
+    }
+    return -1;
+}
+
+int
+header_table_lookup_tvb(const header_table_t *table, tvbuff_t *tvb, const int offset, const unsigned len)
+{
+    return header_table_lookup(table, (const char *)tvb_get_ptr(tvb, offset, len), len);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
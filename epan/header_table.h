@@ -0,0 +1,82 @@
+/** @file
+ * Case-insensitive lookup of protocol header names
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+#ifndef __HEADER_TABLE_H__
+#define __HEADER_TABLE_H__
+
+#include <stddef.h>
+
+#include "ws_symbol_export.h"
+#include <epan/tvbuff.h>
+#include <epan/wmem_scopes.h>
+#include <wsutil/array.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A header table maps the names of a text protocol's known headers (HTTP,
+ * SIP, MSRP...) to their index in the dissector's table of headers. It is
+ * built once, when the dissector registers, as a perfect hash of the names,
+ * so that a lookup hashes the name once and compares it with at most one
+ * known header.
+ */
+typedef struct _header_table header_table_t;
+
+/**
+ * Builds a header table from an array of structures that each hold the
+ * name of a header.
+ *
+ * @param scope The scope the table is allocated in, usually wmem_epan_scope().
+ * @param first_name The name member of the first structure of the array.
+ * @param count The number of structures in the array.
+ * @param stride The size of each structure, or sizeof(char *) for an array
+ * of names.
+ * @return The table. The name of the i-th structure is looked up as i.
+ * NULL names are skipped, and names that differ only by case are looked up
+ * as the first of them.
+ */
+WS_DLL_PUBLIC header_table_t *
+header_table_new(wmem_allocator_t *scope, const char * const *first_name, unsigned count, size_t stride);
+
+/** Builds a header table from an array of structures with a name member. */
+#define HEADER_TABLE_NEW(scope, array, member) \
+    header_table_new(scope, &(array)[0].member, (unsigned)array_length(array), sizeof((array)[0]))
+
+/**
+ * Looks up a header name, ignoring case.
+ *
+ * @return The index of the header, or -1 if it isn't in the table.
+ */
+WS_DLL_PUBLIC int
+header_table_lookup(const header_table_t *table, const char *name, size_t len);
+
+/** Looks up a header name in a tvbuff, ignoring case. */
+WS_DLL_PUBLIC int
+header_table_lookup_tvb(const header_table_t *table, tvbuff_t *tvb, const int offset, const unsigned len);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __HEADER_TABLE_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -39,6 +39,7 @@
 #include <epan/expert.h>
 #include <epan/prefs.h>
 #include <epan/range.h>
+#include <epan/dfilter/dfilter.h>
 
 #include <wsutil/str_util.h>
 #include <wsutil/wslog.h>
@@ -198,6 +199,15 @@ destroy_dissector_table(void *data)
 	g_slice_free(struct dissector_table, data);
 }
 
+/* The packet being dissected, for tagging wmem allocation statistics */
+static packet_info *wmem_tag_pinfo;
+
+static const char *
+dissection_wmem_tag(void)
+{
+	return wmem_tag_pinfo ? wmem_tag_pinfo->current_proto : NULL;
+}
+
 void
 packet_init(void)
 {
@@ -218,6 +228,8 @@ packet_init(void)
 			NULL, destroy_heuristic_dissector_list);
 
 	heuristic_short_names  = g_hash_table_new(g_str_hash, g_str_equal);
+
+	wmem_set_tag_func(dissection_wmem_tag);
 }
 
 void
@@ -357,6 +369,9 @@ init_dissection(void)
 	/* Initialize protocol-specific variables. */
 	g_slist_foreach(init_routines, &call_routine, NULL);
 
+	/* Make sure the init routines haven't changed any indexed value_strings. */
+	proto_check_field_strings_indexes();
+
 	/* Initialize the stream-handling tables */
 	stream_init();
 
@@ -479,10 +494,7 @@ mark_frame_as_depended_upon(frame_data *fd, uint32_t frame_num)
 		/* ws_assert(frame_num < fd->num) - we assume in several other
 		 * places in the code that frames don't depend on future
 		 * frames. */
-		if (fd->dependent_frames == NULL) {
-			fd->dependent_frames = g_hash_table_new(g_direct_hash, g_direct_equal);
-		}
-		g_hash_table_add(fd->dependent_frames, GUINT_TO_POINTER(frame_num));
+		frame_data_add_dependency(fd, frame_num);
 	}
 }
 
@@ -653,6 +665,8 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype,
 	frame_dissector_data.file_type_subtype = file_type_subtype;
 	frame_dissector_data.color_edt = edt; /* Used strictly for "coloring rules" */
 
+	wmem_tag_pinfo = &edt->pi;
+
 	TRY {
 		/* Add this tvbuffer into the data_src list */
 		add_new_data_source(&edt->pi, edt->tvb, record_type);
@@ -672,6 +686,7 @@ dissect_record(epan_dissect_t *edt, int file_type_subtype,
 					       record_type);
 	}
 	ENDTRY;
+	wmem_tag_pinfo = NULL;
 	wtap_block_unref(rec->block);
 	rec->block = NULL;
 
@@ -713,6 +728,7 @@ dissect_file(epan_dissect_t *edt, wtap_rec *rec,
 
 	frame_delta_abs_time(edt->session, fd, fd->frame_ref_num, &edt->pi.rel_ts);
 
+	wmem_tag_pinfo = &edt->pi;
 
 	TRY {
 		/*
@@ -746,6 +762,7 @@ dissect_file(epan_dissect_t *edt, wtap_rec *rec,
 					       "[Malformed Record: Packet Length]");
 	}
 	ENDTRY;
+	wmem_tag_pinfo = NULL;
 	wtap_block_unref(rec->block);
 	rec->block = NULL;
 
@@ -890,6 +907,38 @@ static int
 call_dissector_work_error(dissector_handle_t handle, tvbuff_t *tvb,
 			  packet_info *pinfo_arg, proto_tree *tree, void *);
 
+/*
+ * Returns true if the outcome of the early exit filter is known, so
+ * the dissector doesn't need to be called. Only frames that have already
+ * been dissected qualify: on the first pass, conversations, sequence
+ * analysis and reassembly need every dissector below the one that decided
+ * the outcome, otherwise the later frames would be dissected differently.
+ */
+static bool
+dissection_can_stop(packet_info *pinfo, proto_tree *tree)
+{
+	tree_data_t *tree_data;
+	bool         result;
+
+	if (tree == NULL || !PINFO_FD_VISITED(pinfo))
+		return false;
+
+	tree_data = PTREE_DATA(tree);
+	if (tree_data->early_exit_dfilter == NULL)
+		return false;
+
+	if (!tree_data->early_exit &&
+			tree_data->interesting_count != tree_data->early_exit_count) {
+		/* Only evaluate the filter again if one of its fields was
+		 * added since the last check. */
+		tree_data->early_exit_count = tree_data->interesting_count;
+		tree_data->early_exit = dfilter_apply_partial(tree_data->early_exit_dfilter,
+							tree, &result);
+	}
+
+	return tree_data->early_exit;
+}
+
 static int
 call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo,
 		    proto_tree *tree, bool add_proto_name, void *data)
@@ -910,6 +959,14 @@ call_dissector_work(dissector_handle_t handle, tvbuff_t *tvb, packet_info *pinfo
 		return 0;
 	}
 
+	if (dissection_can_stop(pinfo, tree)) {
+		/*
+		 * The filter outcome is known; claim the data so that
+		 * the caller doesn't try other dissectors.
+		 */
+		return tvb_captured_length(tvb);
+	}
+
 	saved_proto = pinfo->current_proto;
 	saved_can_desegment = pinfo->can_desegment;
 	saved_layers_len = wmem_list_count(pinfo->layers);
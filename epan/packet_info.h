@@ -148,7 +148,7 @@ typedef struct _packet_info {
   int16_t src_win_scale;        /**< Rcv.Wind.Shift src applies when sending segments; -1 unknown; -2 disabled */
   int16_t dst_win_scale;        /**< Rcv.Wind.Shift dst applies when sending segments; -1 unknown; -2 disabled */
 
-  GSList* proto_data;          /**< Per packet proto data */
+  struct _proto_data_list *proto_data; /**< Per packet proto data */
 
   GSList* frame_end_routines;
 
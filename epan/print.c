@@ -70,6 +70,10 @@ typedef struct {
     epan_dissect_t  *edt;
 } write_field_data_t;
 
+/* Values of output_fields_t.field_hfids for fields without a single hfid */
+#define FIELD_HFID_NONE     -1  /* Not a registered field, e.g. an expression */
+#define FIELD_HFID_MULTIPLE -2  /* Several fields are registered with that name */
+
 struct _output_fields {
     bool          print_bom;
     bool          print_header;
@@ -79,7 +83,10 @@ struct _output_fields {
     GPtrArray    *fields;
     GPtrArray    *field_dfilters;
     GHashTable   *field_indicies;
+    int          *field_hfids;
     GPtrArray   **field_values;
+    wmem_strbuf_t *value_buf;
+    wmem_strbuf_t *line_buf;
     wmem_map_t   *protocolfilter;
     char          quote;
     bool          escape;
@@ -102,7 +109,7 @@ static void write_specified_fields(fields_format format,
                                    FILE *fh,
                                    json_dumper *dumper);
 static void print_escaped_xml(FILE *fh, const char *unescaped_string);
-static void print_escaped_csv(FILE *fh, const char *unescaped_string, char delimiter, char quote_char, bool escape_wsp);
+static void append_escaped_csv(wmem_strbuf_t *buf, const char *unescaped_string, char delimiter, char quote_char, bool escape_wsp);
 
 typedef void (*proto_node_value_writer)(proto_node *, write_json_data *);
 static void write_json_index(json_dumper *dumper, epan_dissect_t *edt);
@@ -1873,9 +1880,9 @@ print_escaped_xml(FILE *fh, const char *unescaped_string)
 }
 
 static void
-print_escaped_csv(FILE *fh, const char *unescaped_string, char delimiter, char quote_char, bool escape_wsp)
+append_escaped_csv(wmem_strbuf_t *buf, const char *unescaped_string, char delimiter, char quote_char, bool escape_wsp)
 {
-    if (fh == NULL || unescaped_string == NULL) {
+    if (buf == NULL || unescaped_string == NULL) {
         return;
     }
 
@@ -1885,15 +1892,12 @@ print_escaped_csv(FILE *fh, const char *unescaped_string, char delimiter, char q
      * Should there be a "escape all non ASCII?" option, similar
      * to the Wireshark output?
      */
-    char *escaped_string;
     if (quote_char == '\0') {
         /* Not quoting, so we must escape the delimiter */
-        escaped_string = ws_escape_csv(NULL, unescaped_string, false, delimiter, false, escape_wsp);
+        ws_escape_csv_append(buf, unescaped_string, false, delimiter, false, escape_wsp);
     } else {
-        escaped_string = ws_escape_csv(NULL, unescaped_string, true, quote_char, true, escape_wsp);
+        ws_escape_csv_append(buf, unescaped_string, true, quote_char, true, escape_wsp);
     }
-    fputs(escaped_string, fh);
-    wmem_free(NULL, escaped_string);
 }
 
 static void
@@ -2058,10 +2062,17 @@ void output_fields_free(output_fields_t* fields)
             g_ptr_array_unref(fields->field_dfilters);
         }
 
+        g_free(fields->field_hfids);
+
         if (NULL != fields->field_values) {
             g_free(fields->field_values);
         }
 
+        if (NULL != fields->value_buf) {
+            wmem_strbuf_destroy(fields->value_buf);
+            wmem_strbuf_destroy(fields->line_buf);
+        }
+
         for (i = 0; i < fields->fields->len; ++i) {
             char* field = (char *)g_ptr_array_index(fields->fields,i);
             g_free(field);
@@ -2455,11 +2466,156 @@ static void format_field_values(output_fields_t* fields, void *field_index, char
     g_ptr_array_add(fv_p, (void *)value);
 }
 
+/*
+ * Fields that were primed for printing are tracked in the tree's
+ * interesting field arrays, so their field_infos can be found directly
+ * instead of by walking the whole tree. That only works for names that
+ * map to a single hfid, as the arrays for several hfids with the same name
+ * can't be merged back into tree order.
+ *
+ * Returns true, and sets finfos to the (possibly NULL) array, if the
+ * values of the field at indx can be found that way.
+ */
+static bool
+output_field_get_finfos(output_fields_t *fields, epan_dissect_t *edt, unsigned indx, GPtrArray **finfos)
+{
+    header_field_info *hfinfo;
+    int hfid = fields->field_hfids[indx];
+
+    if (hfid < 0 || edt->tree == NULL) {
+        return false;
+    }
+
+    hfinfo = proto_registrar_get_nth(hfid);
+    if (hfinfo->ref_type != HF_REF_TYPE_DIRECT && hfinfo->ref_type != HF_REF_TYPE_PRINT) {
+        /* Not primed, so not tracked. */
+        return false;
+    }
+
+    *finfos = proto_get_finfo_ptr_array(edt->tree, hfid);
+    return true;
+}
+
+/*
+ * Appends the value of a field to buf, as get_node_field_value() would
+ * return it, but formatting integers and addresses in place instead of
+ * in an allocated string.
+ *
+ * Returns false, leaving buf unchanged, if the field has no value.
+ */
+static bool
+append_node_field_value(wmem_strbuf_t *buf, field_info *fi, epan_dissect_t *edt)
+{
+    header_field_info *hfinfo = fi->hfinfo;
+    char      str_buf[WS_INET6_ADDRSTRLEN];
+    char     *str;
+    uint64_t  uval;
+    int64_t   sval;
+
+    if (hfinfo->id != hf_text_only && hfinfo->id != proto_data && fi->value != NULL) {
+        if (FT_IS_UINT(hfinfo->type) && hfinfo->type != FT_CHAR &&
+            FIELD_DISPLAY(hfinfo->display) != BASE_HEX &&
+            FIELD_DISPLAY(hfinfo->display) != BASE_HEX_DEC &&
+            fvalue_to_uinteger64(fi->value, &uval) == FT_OK) {
+            uint64_to_str_buf(uval, str_buf, sizeof(str_buf));
+            wmem_strbuf_append(buf, str_buf);
+            return true;
+        }
+        if (FT_IS_INT(hfinfo->type) &&
+            fvalue_to_sinteger64(fi->value, &sval) == FT_OK) {
+            if (sval < 0) {
+                wmem_strbuf_append_c(buf, '-');
+                uval = -(uint64_t)sval;
+            } else {
+                uval = sval;
+            }
+            uint64_to_str_buf(uval, str_buf, sizeof(str_buf));
+            wmem_strbuf_append(buf, str_buf);
+            return true;
+        }
+        if (hfinfo->type == FT_IPv4) {
+            const ipv4_addr_and_mask *ipv4 = fvalue_get_ipv4(fi->value);
+            if (ipv4->nmask == 0 || ipv4->nmask == 0xffffffff) {
+                ip_num_to_str_buf(ipv4->addr, str_buf, sizeof(str_buf));
+                wmem_strbuf_append(buf, str_buf);
+                return true;
+            }
+        }
+        if (hfinfo->type == FT_IPv6) {
+            const ipv6_addr_and_prefix *ipv6 = fvalue_get_ipv6(fi->value);
+            if (ipv6->prefix == 0 || ipv6->prefix == 128) {
+                ip6_to_str_buf(&ipv6->addr, str_buf, sizeof(str_buf));
+                wmem_strbuf_append(buf, str_buf);
+                return true;
+            }
+        }
+    }
+
+    str = get_node_field_value(fi, edt);
+    if (str == NULL) {
+        return false;
+    }
+    wmem_strbuf_append(buf, str);
+    g_free(str);
+    return true;
+}
+
+/*
+ * Appends the values of the field_infos in finfos to buf, honoring the
+ * occurrence and aggregator settings.
+ *
+ * Returns the number of values appended.
+ */
+static unsigned
+append_field_values(output_fields_t *fields, GPtrArray *finfos, epan_dissect_t *edt, wmem_strbuf_t *buf)
+{
+    unsigned count = 0;
+    unsigned len;
+    size_t   prev_len;
+
+    if (finfos == NULL) {
+        return 0;
+    }
+    len = finfos->len;
+
+    switch (fields->occurrence) {
+    case 'f':
+        for (unsigned i = 0; i < len && count == 0; i++) {
+            count += append_node_field_value(buf, (field_info *)finfos->pdata[i], edt);
+        }
+        break;
+    case 'l':
+        for (unsigned i = len; i > 0 && count == 0; i--) {
+            count += append_node_field_value(buf, (field_info *)finfos->pdata[i - 1], edt);
+        }
+        break;
+    case 'a':
+        for (unsigned i = 0; i < len; i++) {
+            prev_len = wmem_strbuf_get_len(buf);
+            if (count != 0) {
+                wmem_strbuf_append_c(buf, fields->aggregator);
+            }
+            if (append_node_field_value(buf, (field_info *)finfos->pdata[i], edt)) {
+                count++;
+            } else {
+                wmem_strbuf_truncate(buf, prev_len);
+            }
+        }
+        break;
+    default:
+        ws_assert_not_reached();
+        break;
+    }
+
+    return count;
+}
+
 static void proto_tree_get_node_field_values(proto_node *node, void *data)
 {
     write_field_data_t *call_data;
     field_info *fi;
     void *      field_index;
+    GPtrArray  *finfos;
 
     call_data = (write_field_data_t *)data;
     fi = PNODE_FINFO(node);
@@ -2468,7 +2624,8 @@ static void proto_tree_get_node_field_values(proto_node *node, void *data)
     ws_assert(fi);
 
     field_index = g_hash_table_lookup(call_data->fields->field_indicies, fi->hfinfo->abbrev);
-    if (NULL != field_index) {
+    if (NULL != field_index &&
+        !output_field_get_finfos(call_data->fields, call_data->edt, GPOINTER_TO_UINT(field_index) - 1, &finfos)) {
         format_field_values(call_data->fields, field_index,
                             get_node_field_value(fi, call_data->edt) /* g_ alloc'd string */
             );
@@ -2484,6 +2641,8 @@ static void proto_tree_get_node_field_values(proto_node *node, void *data)
 static void write_specified_fields(fields_format format, output_fields_t *fields, epan_dissect_t *edt, column_info *cinfo _U_, FILE *fh, json_dumper *dumper)
 {
     size_t    i;
+    bool      walk_tree;
+    GPtrArray *finfos;
 
     write_field_data_t data;
 
@@ -2503,15 +2662,25 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
     if (NULL == fields->field_indicies) {
         /* Prepare a lookup table from string abbreviation for field to its index. */
         fields->field_indicies = g_hash_table_new(g_str_hash, g_str_equal);
+        fields->field_hfids = g_new(int, fields->fields->len);
 
         i = 0;
         while (i < fields->fields->len) {
             char *field = (char *)g_ptr_array_index(fields->fields, i);
+            header_field_info *hfinfo = proto_registrar_get_byname(field);
+
+            if (hfinfo == NULL) {
+                fields->field_hfids[i] = FIELD_HFID_NONE;
+            } else if (hfinfo->same_name_prev_id != -1 || hfinfo->same_name_next != NULL) {
+                fields->field_hfids[i] = FIELD_HFID_MULTIPLE;
+            } else {
+                fields->field_hfids[i] = hfinfo->id;
+            }
             /* Store field indicies +1 so that zero is not a valid value,
              * and can be distinguished from NULL as a pointer.
              */
             ++i;
-            if (proto_registrar_get_byname(field)) {
+            if (hfinfo) {
                 g_hash_table_insert(fields->field_indicies, field, GUINT_TO_POINTER(i));
             }
         }
@@ -2554,34 +2723,72 @@ static void write_specified_fields(fields_format format, output_fields_t *fields
         }
     }
 
-    proto_tree_children_foreach(edt->tree, proto_tree_get_node_field_values,
-                                &data);
+    /* Only walk the tree for the fields whose field_infos can't be
+     * found through the interesting hfids. For CSV the others are
+     * formatted straight into the output line below.
+     */
+    walk_tree = false;
+    for (i = 0; i < fields->fields->len; ++i) {
+        if (fields->field_hfids[i] == FIELD_HFID_NONE) {
+            continue;
+        }
+        if (!output_field_get_finfos(fields, edt, (unsigned)i, &finfos)) {
+            walk_tree = true;
+        } else if (format != FORMAT_CSV && finfos != NULL) {
+            for (unsigned j = 0; j < finfos->len; j++) {
+                format_field_values(fields, GUINT_TO_POINTER(i + 1),
+                                    get_node_field_value((field_info *)finfos->pdata[j], edt) /* g_ alloc'd string */
+                    );
+            }
+        }
+    }
+
+    if (walk_tree) {
+        proto_tree_children_foreach(edt->tree, proto_tree_get_node_field_values,
+                                    &data);
+    }
 
     switch (format) {
     case FORMAT_CSV:
+        /* Build the whole line in a buffer kept across packets, and
+         * write it out at once. */
+        if (NULL == fields->line_buf) {
+            fields->value_buf = wmem_strbuf_new_sized(NULL, 256);
+            fields->line_buf = wmem_strbuf_new_sized(NULL, 1024);
+        }
+        wmem_strbuf_truncate(fields->line_buf, 0);
+
         for(i = 0; i < fields->fields->len; ++i) {
+            unsigned count = 0;
+
             if (0 != i) {
-                fputc(fields->separator, fh);
+                wmem_strbuf_append_c(fields->line_buf, fields->separator);
             }
-            if (NULL != fields->field_values[i]) {
+            wmem_strbuf_truncate(fields->value_buf, 0);
+            if (fields->field_hfids[i] != FIELD_HFID_NONE &&
+                output_field_get_finfos(fields, edt, (unsigned)i, &finfos)) {
+                count = append_field_values(fields, finfos, edt, fields->value_buf);
+            } else if (NULL != fields->field_values[i]) {
                 GPtrArray *fv_p;
                 size_t j;
                 fv_p = fields->field_values[i];
 
                 /* Output the array of (partial) field values */
-                if (g_ptr_array_len(fv_p) != 0) {
-                    wmem_strbuf_t *buf = wmem_strbuf_new(NULL, g_ptr_array_index(fv_p, 0));
-                    for (j = 1; j < g_ptr_array_len(fv_p); j++ ) {
-                        wmem_strbuf_append_c(buf, fields->aggregator);
-                        wmem_strbuf_append(buf, (char *)g_ptr_array_index(fv_p, j));
+                count = g_ptr_array_len(fv_p);
+                for (j = 0; j < count; j++ ) {
+                    if (j != 0) {
+                        wmem_strbuf_append_c(fields->value_buf, fields->aggregator);
                     }
-                    print_escaped_csv(fh, wmem_strbuf_get_str(buf), fields->separator, fields->quote, fields->escape);
-                    wmem_strbuf_destroy(buf);
+                    wmem_strbuf_append(fields->value_buf, (char *)g_ptr_array_index(fv_p, j));
                 }
                 g_ptr_array_free(fv_p, true);  /* get ready for the next packet */
                 fields->field_values[i] = NULL;
             }
+            if (count != 0) {
+                append_escaped_csv(fields->line_buf, wmem_strbuf_get_str(fields->value_buf), fields->separator, fields->quote, fields->escape);
+            }
         }
+        fwrite(wmem_strbuf_get_str(fields->line_buf), 1, wmem_strbuf_get_len(fields->line_buf), fh);
         break;
     case FORMAT_XML:
         for(i = 0; i < fields->fields->len; ++i) {
@@ -2809,7 +3016,10 @@ output_fields_t* output_fields_new(void)
     fields->fields              = NULL; /*Do lazy initialisation */
     fields->field_dfilters      = NULL;
     fields->field_indicies      = NULL;
+    fields->field_hfids         = NULL;
     fields->field_values        = NULL;
+    fields->value_buf           = NULL;
+    fields->line_buf            = NULL;
     fields->protocolfilter      = NULL;
     fields->quote               ='\0';
     fields->escape              = true;
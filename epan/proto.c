@@ -384,6 +384,7 @@ static expert_field ei_string_trailing_characters;
 static void register_string_errors(void);
 
 static int proto_register_field_init(header_field_info *hfinfo, const int parent);
+static void proto_index_field_strings(const header_field_info *hfinfo);
 
 /* special-case header field used within proto.c */
 static header_field_info hfi_text_only =
@@ -460,6 +461,29 @@ typedef struct _gpa_hfinfo_t {
 
 static gpa_hfinfo_t gpa_hfinfo;
 
+/*
+ * Fields primed for filtering or printing are given dense slot numbers,
+ * the first time they are primed, so that the field_infos of each tree
+ * can be kept in an array indexed by slot rather than in a hash table.
+ * A slot is kept for the rest of the session, so its per-tree array can
+ * be reused from one packet to the next.
+ */
+static unsigned *interesting_slots;		/* hfid -> slot + 1, or 0 */
+static unsigned  interesting_slots_len;
+static int      *interesting_slot_hfids;	/* slot -> hfid */
+static unsigned  interesting_slot_count;
+
+/*
+ * Indexes of the value_strings of integer fields, built when the fields
+ * are registered so that their labels don't need a linear search.
+ * hf_vs_indexes is indexed by hfid. Tables shared by several fields share
+ * an index; vs_indexes finds it, and vs_index_list owns all of them.
+ */
+static value_string_index **hf_vs_indexes;
+static unsigned             hf_vs_indexes_len;
+static GHashTable          *vs_indexes;	/* value_string * -> value_string_index * */
+static GPtrArray           *vs_index_list;
+
 /* Hash table of abbreviations and IDs */
 static GHashTable *gpa_name_map;
 static header_field_info *same_name_hfinfo;
@@ -679,6 +703,25 @@ proto_cleanup_base(void)
 	g_free(last_field_name);
 	last_field_name = NULL;
 
+	g_free(interesting_slots);
+	interesting_slots = NULL;
+	interesting_slots_len = 0;
+	g_free(interesting_slot_hfids);
+	interesting_slot_hfids = NULL;
+	interesting_slot_count = 0;
+
+	g_free(hf_vs_indexes);
+	hf_vs_indexes = NULL;
+	hf_vs_indexes_len = 0;
+	if (vs_indexes) {
+		g_hash_table_destroy(vs_indexes);
+		vs_indexes = NULL;
+	}
+	if (vs_index_list) {
+		g_ptr_array_free(vs_index_list, true);
+		vs_index_list = NULL;
+	}
+
 	while (protocols) {
 		protocol = (protocol_t *)protocols->data;
 		PROTO_REGISTRAR_GET_NTH(protocol->proto_id, hfinfo);
@@ -806,10 +849,8 @@ proto_tree_children_foreach(proto_tree *tree, proto_tree_foreach_func func,
 }
 
 static void
-free_GPtrArray_value(void *key, void *value, void *user_data _U_)
+reset_interesting_ref_type(int hfid)
 {
-	GPtrArray         *ptrs = (GPtrArray *)value;
-	int                hfid = GPOINTER_TO_UINT(key);
 	header_field_info *hfinfo;
 
 	PROTO_REGISTRAR_GET_NTH(hfid, hfinfo);
@@ -825,8 +866,6 @@ free_GPtrArray_value(void *key, void *value, void *user_data _U_)
 		}
 		hfinfo->ref_type = HF_REF_TYPE_NONE;
 	}
-
-	g_ptr_array_free(ptrs, true);
 }
 
 static void
@@ -847,19 +886,24 @@ proto_tree_reset(proto_tree *tree)
 
 	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
 
-	/* free tree data */
-	if (tree_data->interesting_hfids) {
-		/* Free all the GPtrArray's in the interesting_hfids hash. */
-		g_hash_table_foreach(tree_data->interesting_hfids,
-			free_GPtrArray_value, NULL);
+	/* Empty the interesting field arrays, but keep them for the next
+	 * packet. */
+	for (unsigned slot = 0; slot < tree_data->interesting_len; slot++) {
+		GPtrArray *ptrs = tree_data->interesting_fields[slot];
 
-		/* And then remove all values. */
-		g_hash_table_remove_all(tree_data->interesting_hfids);
+		if (ptrs && ptrs->len) {
+			reset_interesting_ref_type(interesting_slot_hfids[slot]);
+			g_ptr_array_set_size(ptrs, 0);
+		}
 	}
 
 	/* Reset track of the number of children */
 	tree_data->count = 0;
 
+	tree_data->interesting_count = 0;
+	tree_data->early_exit_count = 0;
+	tree_data->early_exit = false;
+
 	PROTO_NODE_INIT(tree);
 }
 
@@ -872,14 +916,16 @@ proto_tree_free(proto_tree *tree)
 	proto_tree_children_foreach(tree, proto_tree_free_node, NULL);
 
 	/* free tree data */
-	if (tree_data->interesting_hfids) {
-		/* Free all the GPtrArray's in the interesting_hfids hash. */
-		g_hash_table_foreach(tree_data->interesting_hfids,
-			free_GPtrArray_value, NULL);
+	for (unsigned slot = 0; slot < tree_data->interesting_len; slot++) {
+		GPtrArray *ptrs = tree_data->interesting_fields[slot];
 
-		/* And then destroy the hash. */
-		g_hash_table_destroy(tree_data->interesting_hfids);
+		if (ptrs) {
+			if (ptrs->len)
+				reset_interesting_ref_type(interesting_slot_hfids[slot]);
+			g_ptr_array_free(ptrs, true);
+		}
 	}
+	g_free(tree_data->interesting_fields);
 
 	g_slice_free(tree_data_t, tree_data);
 
@@ -2659,31 +2705,57 @@ get_time_value(proto_tree *tree, tvbuff_t *tvb, const int start,
 	}
 }
 
+/* Gives a field a slot in the trees' interesting field arrays, if it
+ * doesn't already have one, and returns it. */
+static unsigned
+interesting_slot_assign(const int hfid)
+{
+	if ((unsigned)hfid >= interesting_slots_len) {
+		unsigned len = MAX(gpa_hfinfo.len, (unsigned)hfid + 1);
+
+		interesting_slots = g_renew(unsigned, interesting_slots, len);
+		memset(interesting_slots + interesting_slots_len, 0,
+		       (len - interesting_slots_len) * sizeof(unsigned));
+		interesting_slots_len = len;
+	}
+
+	if (interesting_slots[hfid] == 0) {
+		interesting_slot_hfids = g_renew(int, interesting_slot_hfids,
+						 interesting_slot_count + 1);
+		interesting_slot_hfids[interesting_slot_count++] = hfid;
+		interesting_slots[hfid] = interesting_slot_count;
+	}
+
+	return interesting_slots[hfid] - 1;
+}
+
 static void
 tree_data_add_maybe_interesting_field(tree_data_t *tree_data, field_info *fi)
 {
 	const header_field_info *hfinfo = fi->hfinfo;
 
 	if (hfinfo->ref_type == HF_REF_TYPE_DIRECT || hfinfo->ref_type == HF_REF_TYPE_PRINT) {
-		GPtrArray *ptrs = NULL;
-
-		if (tree_data->interesting_hfids == NULL) {
-			/* Initialize the hash because we now know that it is needed */
-			tree_data->interesting_hfids =
-				g_hash_table_new(g_direct_hash, NULL /* g_direct_equal */);
-		} else if (g_hash_table_size(tree_data->interesting_hfids)) {
-			ptrs = (GPtrArray *)g_hash_table_lookup(tree_data->interesting_hfids,
-					   GINT_TO_POINTER(hfinfo->id));
+		unsigned   slot = interesting_slot_assign(hfinfo->id);
+		GPtrArray *ptrs;
+
+		if (slot >= tree_data->interesting_len) {
+			/* Fields were primed since the array was sized */
+			tree_data->interesting_fields = g_renew(GPtrArray *,
+					tree_data->interesting_fields, interesting_slot_count);
+			memset(tree_data->interesting_fields + tree_data->interesting_len, 0,
+			       (interesting_slot_count - tree_data->interesting_len) * sizeof(GPtrArray *));
+			tree_data->interesting_len = interesting_slot_count;
 		}
 
+		ptrs = tree_data->interesting_fields[slot];
 		if (!ptrs) {
 			/* First element triggers the creation of pointer array */
 			ptrs = g_ptr_array_new();
-			g_hash_table_insert(tree_data->interesting_hfids,
-					    GINT_TO_POINTER(hfinfo->id), ptrs);
+			tree_data->interesting_fields[slot] = ptrs;
 		}
 
 		g_ptr_array_add(ptrs, fi);
+		tree_data->interesting_count++;
 	}
 }
 
@@ -7810,8 +7882,9 @@ proto_tree_create_root(packet_info *pinfo)
 	/* Make sure we can access pinfo everywhere */
 	pnode->tree_data->pinfo = pinfo;
 
-	/* Don't initialize the tree_data_t. Wait until we know we need it */
-	pnode->tree_data->interesting_hfids = NULL;
+	/* Don't allocate the interesting field arrays until we know we need them */
+	pnode->tree_data->interesting_fields = NULL;
+	pnode->tree_data->interesting_len = 0;
 
 	/* Set the default to false so it's easier to
 	 * find errors; if we expect to see the protocol tree
@@ -7825,6 +7898,12 @@ proto_tree_create_root(packet_info *pinfo)
 	/* Keep track of the number of children */
 	pnode->tree_data->count = 0;
 
+	/* Don't stop dissection early unless asked to */
+	pnode->tree_data->early_exit_dfilter = NULL;
+	pnode->tree_data->interesting_count = 0;
+	pnode->tree_data->early_exit_count = 0;
+	pnode->tree_data->early_exit = false;
+
 	return (proto_tree *)pnode;
 }
 
@@ -7845,6 +7924,7 @@ proto_tree_prime_with_hfid(proto_tree *tree _U_, const int hfid)
 	if (hfinfo->ref_type != HF_REF_TYPE_PRINT) {
 		hfinfo->ref_type = HF_REF_TYPE_DIRECT;
 	}
+	interesting_slot_assign(hfid);
 	/* only increase the refcount if there is a parent.
 	   if this is a protocol and not a field then parent will be -1
 	   and there is no parent to add any refcounting for.
@@ -7873,6 +7953,7 @@ proto_tree_prime_with_hfid_print(proto_tree *tree _U_, const int hfid)
 	   also increase the refcount for the parent, i.e the protocol.
 	*/
 	hfinfo->ref_type = HF_REF_TYPE_PRINT;
+	interesting_slot_assign(hfid);
 	/* only increase the refcount if there is a parent.
 	   if this is a protocol and not a field then parent will be -1
 	   and there is no parent to add any refcounting for.
@@ -8753,6 +8834,8 @@ proto_deregister_field (const int parent, int hf_id)
 			g_hash_table_steal(gpa_name_map, hfi->abbrev);
 			g_ptr_array_remove_index_fast(proto->fields, i);
 			g_ptr_array_add(deregistered_fields, gpa_hfinfo.hfi[hf_id]);
+			if ((unsigned)hf_id < hf_vs_indexes_len)
+				hf_vs_indexes[hf_id] = NULL;
 			return;
 		}
 	}
@@ -9712,9 +9795,99 @@ proto_register_field_init(header_field_info *hfinfo, const int parent)
 		}
 	}
 
+	proto_index_field_strings(hfinfo);
+
 	return hfinfo->id;
 }
 
+/* Builds, or finds, an index of the value_string of an integer field */
+static void
+proto_index_field_strings(const header_field_info *hfinfo)
+{
+	const value_string *vs;
+	value_string_index *vsi;
+
+	switch (hfinfo->type) {
+
+		case FT_CHAR:
+		case FT_UINT8:
+		case FT_UINT16:
+		case FT_UINT24:
+		case FT_UINT32:
+		case FT_INT8:
+		case FT_INT16:
+		case FT_INT24:
+		case FT_INT32:
+			break;
+
+		default:
+			return;
+	}
+	if (hfinfo->strings == NULL ||
+	    (hfinfo->display & (BASE_RANGE_STRING|BASE_EXT_STRING|BASE_VAL64_STRING|BASE_UNIT_STRING)) ||
+	    FIELD_DISPLAY(hfinfo->display) == BASE_CUSTOM)
+		return;
+
+	vs = (const value_string *)hfinfo->strings;
+	if (vs_indexes == NULL) {
+		vs_indexes = g_hash_table_new(g_direct_hash, g_direct_equal);
+		vs_index_list = g_ptr_array_new_with_free_func((GDestroyNotify)value_string_index_free);
+	}
+
+	/* The table may have been freed with a deregistered field and another
+	 * one allocated at the same address, so check the index still fits. */
+	vsi = (value_string_index *)g_hash_table_lookup(vs_indexes, vs);
+	if (vsi == NULL || !value_string_index_is_current(vsi)) {
+		vsi = value_string_index_new(vs);
+		if (vsi == NULL)
+			return;
+		g_hash_table_insert(vs_indexes, (void *)vs, vsi);
+		g_ptr_array_add(vs_index_list, vsi);
+	}
+
+	if (hf_vs_indexes_len < gpa_hfinfo.allocated_len) {
+		hf_vs_indexes = g_renew(value_string_index *, hf_vs_indexes, gpa_hfinfo.allocated_len);
+		memset(hf_vs_indexes + hf_vs_indexes_len, 0,
+		       (gpa_hfinfo.allocated_len - hf_vs_indexes_len) * sizeof(value_string_index *));
+		hf_vs_indexes_len = gpa_hfinfo.allocated_len;
+	}
+	hf_vs_indexes[hfinfo->id] = vsi;
+}
+
+void
+proto_check_field_strings_indexes(void)
+{
+	GHashTable *checked;
+
+	if (hf_vs_indexes == NULL)
+		return;
+
+	/* Dissectors aren't supposed to change the value_strings of their
+	 * fields, but if one does, go back to searching it linearly. Only the
+	 * indexes of registered fields are checked, as the tables of
+	 * deregistered ones may have been freed. */
+	checked = g_hash_table_new(g_direct_hash, g_direct_equal);
+	for (unsigned hfid = 0; hfid < hf_vs_indexes_len && hfid < gpa_hfinfo.len; hfid++) {
+		value_string_index *vsi = hf_vs_indexes[hfid];
+		void *current;
+
+		if (vsi == NULL)
+			continue;
+		if (!g_hash_table_lookup_extended(checked, vsi, NULL, &current)) {
+			current = GINT_TO_POINTER(value_string_index_is_current(vsi));
+			g_hash_table_insert(checked, vsi, current);
+			if (!current && g_hash_table_lookup(vs_indexes, value_string_index_get_vs(vsi)) == vsi)
+				g_hash_table_remove(vs_indexes, value_string_index_get_vs(vsi));
+		}
+		if (!current) {
+			ws_debug("value_string of %s changed after registration; searching it linearly",
+				 gpa_hfinfo.hfi[hfid]->abbrev);
+			hf_vs_indexes[hfid] = NULL;
+		}
+	}
+	g_hash_table_destroy(checked);
+}
+
 void
 proto_register_subtree_array(int * const *indices, const int num_indices)
 {
@@ -10173,6 +10346,13 @@ hf_try_val_to_str(uint32_t value, const header_field_info *hfinfo)
 	if (hfinfo->display & BASE_UNIT_STRING)
 		return unit_name_string_get_value(value, (const struct unit_name_string*) hfinfo->strings);
 
+	if ((unsigned)hfinfo->id < hf_vs_indexes_len) {
+		const value_string_index *vsi = hf_vs_indexes[hfinfo->id];
+
+		if (vsi && value_string_index_get_vs(vsi) == hfinfo->strings)
+			return try_val_to_str_indexed(value, vsi);
+	}
+
 	return try_val_to_str(value, (const value_string *) hfinfo->strings);
 }
 
@@ -11194,27 +11374,34 @@ proto_check_for_protocol_or_field(const proto_tree* tree, const int id)
 GPtrArray *
 proto_get_finfo_ptr_array(const proto_tree *tree, const int id)
 {
-	if (!tree)
+	const tree_data_t *tree_data;
+	GPtrArray         *ptrs;
+	unsigned           slot;
+
+	if (!tree || (unsigned)id >= interesting_slots_len)
 		return NULL;
 
-	if (PTREE_DATA(tree)->interesting_hfids != NULL)
-		return (GPtrArray *)g_hash_table_lookup(PTREE_DATA(tree)->interesting_hfids,
-					   GINT_TO_POINTER(id));
-	else
+	tree_data = PTREE_DATA(tree);
+	slot = interesting_slots[id];
+	if (slot == 0 || slot > tree_data->interesting_len)
 		return NULL;
+
+	/* The arrays are kept, emptied, between packets; an empty one
+	 * means the field isn't in this tree. */
+	ptrs = tree_data->interesting_fields[slot - 1];
+	if (ptrs == NULL || ptrs->len == 0)
+		return NULL;
+
+	return ptrs;
 }
 
 bool
 proto_tracking_interesting_fields(const proto_tree *tree)
 {
-	GHashTable *interesting_hfids;
-
 	if (!tree)
 		return false;
 
-	interesting_hfids = PTREE_DATA(tree)->interesting_hfids;
-
-	return (interesting_hfids != NULL) && g_hash_table_size(interesting_hfids);
+	return PTREE_DATA(tree)->interesting_count != 0;
 }
 
 /* Helper struct for proto_find_info() and	proto_all_finfos() */
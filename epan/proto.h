@@ -889,11 +889,17 @@ typedef struct
 /** One of these exists for the entire protocol tree. Each proto_node
  * in the protocol tree points to the same copy. */
 typedef struct {
-    GHashTable          *interesting_hfids;
+    GPtrArray          **interesting_fields; /* field_infos of primed fields, by slot */
+    unsigned             interesting_len;    /* number of interesting_fields slots */
     bool                 visible;
     bool                 fake_protocols;
     unsigned             count;
     struct _packet_info *pinfo;
+    /* Filter whose outcome, once known, stops further dissection. */
+    struct epan_dfilter *early_exit_dfilter;
+    unsigned             interesting_count;  /* interesting fields added */
+    unsigned             early_exit_count;   /* interesting_count at the last check */
+    bool                 early_exit;         /* the filter outcome is known */
 } tree_data_t;
 
 /** Each proto_tree, proto_item is one of these. */
@@ -1088,6 +1094,11 @@ void proto_init(GSList *register_all_plugin_protocols_list,
 /** Frees memory used by proto routines. Called at program shutdown */
 extern void proto_cleanup(void);
 
+/** Checks that the value_strings indexed when fields were registered haven't
+    changed since, and stops using the indexes of any that have. Called when
+    dissection is (re)initialized. */
+extern void proto_check_field_strings_indexes(void);
+
 /** This function takes a tree and a protocol id as parameter and
     will return true/false for whether the protocol or any of the filterable
     fields in the protocol is referenced by any filters.
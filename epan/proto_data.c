@@ -10,6 +10,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/wmem_scopes.h>
@@ -26,73 +28,82 @@ typedef struct _proto_data {
   void *proto_data;
 } proto_data_t;
 
-static int
-p_compare(const void *a, const void *b)
+/* The entries of a frame or packet, in the order they were added. Frames
+   rarely have more than a handful of entries, so a linear search of an
+   array beats anything fancier, and it is much cheaper than walking a
+   GSList of separately allocated entries. The array is allocated with
+   g_malloc() and freed by the owner of the frame_data or packet_info. */
+struct _proto_data_list {
+  unsigned      count;
+  unsigned      size;
+  proto_data_t  entries[];
+};
+
+#define PROTO_DATA_LIST_MIN_SIZE 4
+
+static proto_data_list_t **
+p_get_list(wmem_allocator_t *scope, struct _packet_info* pinfo)
+{
+  if (scope == pinfo->pool) {
+    return &pinfo->proto_data;
+  } else if (scope == wmem_file_scope()) {
+    return &pinfo->fd->pfd;
+  }
+  DISSECTOR_ASSERT(!"invalid wmem scope");
+  return NULL;
+}
+
+/* Find the most recently added entry for (proto, key) */
+static proto_data_t *
+p_find(proto_data_list_t *list, int proto, uint32_t key)
 {
-  const proto_data_t *ap = (const proto_data_t *)a;
-  const proto_data_t *bp = (const proto_data_t *)b;
-
-  if (ap -> proto > bp -> proto) {
-    return 1;
-  } else if (ap -> proto == bp -> proto) {
-    if (ap->key > bp->key){
-      return 1;
-    } else if (ap -> key == bp -> key) {
-      return 0;
+  unsigned i;
+
+  if (list == NULL) {
+    return NULL;
+  }
+
+  for (i = list->count; i > 0; i--) {
+    proto_data_t *pd = &list->entries[i - 1];
+
+    if (pd->proto == proto && pd->key == key) {
+      return pd;
     }
-    return -1;
-  } else {
-    return -1;
   }
+
+  return NULL;
 }
 
 void
 p_add_proto_data(wmem_allocator_t *tmp_scope, struct _packet_info* pinfo, int proto, uint32_t key, void *proto_data)
 {
-  proto_data_t     *p1;
-  GSList          **proto_list;
-  wmem_allocator_t *scope;
-
-  if (tmp_scope == pinfo->pool) {
-    scope = tmp_scope;
-    proto_list = &pinfo->proto_data;
-  } else if (tmp_scope == wmem_file_scope()) {
-    scope = wmem_file_scope();
-    proto_list = &pinfo->fd->pfd;
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
-  }
+  proto_data_list_t **list_p = p_get_list(tmp_scope, pinfo);
+  proto_data_list_t  *list = *list_p;
+  proto_data_t       *p1;
 
-  p1 = wmem_new(scope, proto_data_t);
+  if (list == NULL || list->count == list->size) {
+    unsigned size = list ? list->size * 2 : PROTO_DATA_LIST_MIN_SIZE;
 
+    list = (proto_data_list_t *)g_realloc(list, sizeof(proto_data_list_t) + size * sizeof(proto_data_t));
+    if (*list_p == NULL) {
+      list->count = 0;
+    }
+    list->size = size;
+    *list_p = list;
+  }
+
+  p1 = &list->entries[list->count++];
   p1->proto = proto;
   p1->key = key;
   p1->proto_data = proto_data;
-
-  /* Add it to the GSLIST */
-  *proto_list = g_slist_prepend(*proto_list, p1);
 }
 
 void
 p_set_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key, void *proto_data)
 {
-  proto_data_t  temp;
-  GSList       *item;
-
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  proto_data_t *pd = p_find(*p_get_list(scope, pinfo), proto, key);
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
-  }
-
-  if (item) {
-    proto_data_t *pd = (proto_data_t *)item->data;
+  if (pd) {
     pd->proto_data = proto_data;
     return;
   }
@@ -103,24 +114,10 @@ p_set_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto,
 void *
 p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key)
 {
-  proto_data_t  temp, *p1;
-  GSList       *item;
-
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  proto_data_t *pd = p_find(*p_get_list(scope, pinfo), proto, key);
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
-  }
-
-  if (item) {
-    p1 = (proto_data_t *)item->data;
-    return p1->proto_data;
+  if (pd) {
+    return pd->proto_data;
   }
 
   return NULL;
@@ -129,40 +126,34 @@ p_get_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto,
 void
 p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key)
 {
-  proto_data_t  temp;
-  GSList       *item;
-  GSList      **proto_list;
+  proto_data_list_t *list = *p_get_list(scope, pinfo);
+  proto_data_t      *pd = p_find(list, proto, key);
 
-  temp.proto = proto;
-  temp.key = key;
-  temp.proto_data = NULL;
+  if (pd) {
+    unsigned i = (unsigned)(pd - list->entries);
 
-  if (scope == pinfo->pool) {
-    item = g_slist_find_custom(pinfo->proto_data, &temp, p_compare);
-    proto_list = &pinfo->proto_data;
-  } else if (scope == wmem_file_scope()) {
-    item = g_slist_find_custom(pinfo->fd->pfd, &temp, p_compare);
-    proto_list = &pinfo->fd->pfd;
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
+    memmove(pd, pd + 1, (list->count - i - 1) * sizeof(proto_data_t));
+    list->count--;
   }
+}
 
-  if (item) {
-    *proto_list = g_slist_remove(*proto_list, item->data);
-  }
+unsigned
+p_get_proto_data_count(wmem_allocator_t *scope, struct _packet_info* pinfo)
+{
+  proto_data_list_t *list = *p_get_list(scope, pinfo);
+
+  return list ? list->count : 0;
 }
 
 char *
 p_get_proto_name_and_key(wmem_allocator_t *scope, struct _packet_info* pinfo, unsigned pfd_index){
-  proto_data_t  *temp;
+  proto_data_list_t *list = *p_get_list(scope, pinfo);
+  proto_data_t      *temp;
 
-  if (scope == pinfo->pool) {
-    temp = (proto_data_t *)g_slist_nth_data(pinfo->proto_data, pfd_index);
-  } else if (scope == wmem_file_scope()) {
-    temp = (proto_data_t *)g_slist_nth_data(pinfo->fd->pfd, pfd_index);
-  } else {
-    DISSECTOR_ASSERT(!"invalid wmem scope");
-  }
+  DISSECTOR_ASSERT(list != NULL && pfd_index < list->count);
+
+  /* Index 0 is the most recently added entry */
+  temp = &list->entries[list->count - pfd_index - 1];
 
   return wmem_strdup_printf(pinfo->pool, "[%s, key %u]",proto_get_protocol_name(temp->proto), temp->key);
 }
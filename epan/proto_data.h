@@ -28,6 +28,9 @@ extern "C" {
 
 /* Allocator should be either pinfo->pool or wmem_file_scope() */
 
+/** The protocol data of a frame or packet. */
+typedef struct _proto_data_list proto_data_list_t;
+
 /**
  * Add data associated with a protocol.
  *
@@ -86,6 +89,15 @@ WS_DLL_PUBLIC void *p_get_proto_data(wmem_allocator_t *scope, struct _packet_inf
  */
 WS_DLL_PUBLIC void p_remove_proto_data(wmem_allocator_t *scope, struct _packet_info* pinfo, int proto, uint32_t key);
 
+/**
+ * Get the number of protocol data entries.
+ *
+ * @param scope The memory scope, either pinfo->pool or wmem_file_scope().
+ * @param pinfo This dissection's packet info.
+ * @return The number of entries in the scope's protocol data list.
+ */
+unsigned p_get_proto_data_count(wmem_allocator_t *scope, struct _packet_info* pinfo);
+
 char *p_get_proto_name_and_key(wmem_allocator_t *scope, struct _packet_info* pinfo, unsigned pfd_index);
 
 /**
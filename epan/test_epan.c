@@ -9,6 +9,13 @@
 #include "config.h"
 
 #include "strutil.h"
+#include "packet_info.h"
+#include "proto_data.h"
+#include "conversation_table.h"
+#include "frame_data_sequence.h"
+#include "header_table.h"
+#include "value_string.h"
+#include "wmem_scopes.h"
 #include <wsutil/utf8_entities.h>
 
 /*
@@ -74,6 +81,428 @@ void test_label_escape_control(void)
     g_assert_cmpuint(pos, ==, strlen(dst));
 }
 
+void test_proto_data(void)
+{
+    packet_info pinfo = { 0 };
+    frame_data fd = { 0 };
+    int a = 1, b = 2, c = 3;
+
+    pinfo.fd = &fd;
+    pinfo.pool = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+    wmem_enter_file_scope();
+
+    g_assert_null(p_get_proto_data(pinfo.pool, &pinfo, 10, 0));
+    g_assert_cmpuint(p_get_proto_data_count(pinfo.pool, &pinfo), ==, 0);
+
+    /* The scopes are separate */
+    p_add_proto_data(pinfo.pool, &pinfo, 10, 0, &a);
+    p_add_proto_data(wmem_file_scope(), &pinfo, 10, 0, &b);
+    g_assert_true(p_get_proto_data(pinfo.pool, &pinfo, 10, 0) == &a);
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 10, 0) == &b);
+    g_assert_null(p_get_proto_data(pinfo.pool, &pinfo, 10, 1));
+    g_assert_null(p_get_proto_data(pinfo.pool, &pinfo, 11, 0));
+
+    /* The most recently added entry wins, and removing it reveals the older one */
+    p_add_proto_data(pinfo.pool, &pinfo, 10, 0, &c);
+    g_assert_true(p_get_proto_data(pinfo.pool, &pinfo, 10, 0) == &c);
+    p_remove_proto_data(pinfo.pool, &pinfo, 10, 0);
+    g_assert_true(p_get_proto_data(pinfo.pool, &pinfo, 10, 0) == &a);
+
+    /* Setting replaces the data of an existing entry */
+    p_set_proto_data(pinfo.pool, &pinfo, 10, 0, &b);
+    g_assert_true(p_get_proto_data(pinfo.pool, &pinfo, 10, 0) == &b);
+    g_assert_cmpuint(p_get_proto_data_count(pinfo.pool, &pinfo), ==, 1);
+
+    /* Growing keeps all entries */
+    for (int i = 0; i < 100; i++) {
+        p_add_proto_data(wmem_file_scope(), &pinfo, 20, i, GINT_TO_POINTER(i + 1));
+    }
+    g_assert_cmpuint(p_get_proto_data_count(wmem_file_scope(), &pinfo), ==, 101);
+    for (int i = 0; i < 100; i++) {
+        g_assert_cmpint(GPOINTER_TO_INT(p_get_proto_data(wmem_file_scope(), &pinfo, 20, i)), ==, i + 1);
+    }
+    p_remove_proto_data(wmem_file_scope(), &pinfo, 20, 50);
+    g_assert_null(p_get_proto_data(wmem_file_scope(), &pinfo, 20, 50));
+    g_assert_cmpint(GPOINTER_TO_INT(p_get_proto_data(wmem_file_scope(), &pinfo, 20, 51)), ==, 52);
+    g_assert_true(p_get_proto_data(wmem_file_scope(), &pinfo, 10, 0) == &b);
+
+    wmem_leave_file_scope();
+    frame_data_destroy(&fd);
+    g_free(pinfo.proto_data);
+    wmem_destroy_allocator(pinfo.pool);
+}
+
+/*
+ * Lookups in a frame with data from a deep protocol stack, such as
+ * Ethernet/IP/TCP/TLS/HTTP2/gRPC, each attaching a few keys.
+ */
+void test_proto_data_perf(void)
+{
+    packet_info pinfo = { 0 };
+    frame_data fd = { 0 };
+    const int protos = 8, keys = 3, iterations = 1000000;
+    void *found = NULL;
+
+    pinfo.fd = &fd;
+    pinfo.pool = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+    wmem_enter_file_scope();
+
+    for (int proto = 0; proto < protos; proto++) {
+        for (int key = 0; key < keys; key++) {
+            p_add_proto_data(wmem_file_scope(), &pinfo, proto, key, GINT_TO_POINTER(proto * keys + key + 1));
+        }
+    }
+
+    g_test_timer_start();
+    for (int i = 0; i < iterations; i++) {
+        found = p_get_proto_data(wmem_file_scope(), &pinfo, i % protos, i % keys);
+    }
+    g_test_minimized_result(g_test_timer_elapsed(), "%d lookups in %d entries: %f s",
+            iterations, protos * keys, g_test_timer_last());
+    g_assert_nonnull(found);
+
+    wmem_leave_file_scope();
+    frame_data_destroy(&fd);
+    wmem_destroy_allocator(pinfo.pool);
+}
+
+void test_frame_data_dependencies(void)
+{
+    frame_data_sequence *fds = new_frame_data_sequence();
+    frame_data fd = { 0 };
+    frame_data *fdata;
+    const uint32_t *deps;
+    unsigned count;
+
+    for (uint32_t num = 1; num <= 6; num++) {
+        fd.num = num;
+        frame_data_sequence_add(fds, &fd);
+    }
+
+    /* Kept in order without duplicates */
+    fdata = frame_data_sequence_find(fds, 6);
+    g_assert_cmpuint(frame_data_get_dependencies(fdata, &deps), ==, 0);
+    g_assert_null(deps);
+    frame_data_add_dependency(fdata, 3);
+    frame_data_add_dependency(fdata, 5);
+    frame_data_add_dependency(fdata, 1);
+    frame_data_add_dependency(fdata, 5);
+    frame_data_add_dependency(fdata, 4);
+    frame_data_add_dependency(fdata, 2);
+    frame_data_add_dependency(fdata, 3);
+    count = frame_data_get_dependencies(fdata, &deps);
+    g_assert_cmpuint(count, ==, 5);
+    for (unsigned i = 0; i < count; i++) {
+        g_assert_cmpuint(deps[i], ==, i + 1);
+    }
+
+    /* Marking follows chains: 5 -> 4 -> 2, but not 3 or 1 */
+    frame_data_add_dependency(frame_data_sequence_find(fds, 4), 2);
+    fdata = frame_data_sequence_find(fds, 5);
+    frame_data_add_dependency(fdata, 4);
+    fdata->passed_dfilter = 1;
+    frame_data_sequence_mark_depended_upon(fds, fdata);
+    g_assert_false(frame_data_sequence_find(fds, 1)->dependent_of_displayed);
+    g_assert_true(frame_data_sequence_find(fds, 2)->dependent_of_displayed);
+    g_assert_false(frame_data_sequence_find(fds, 3)->dependent_of_displayed);
+    g_assert_true(frame_data_sequence_find(fds, 4)->dependent_of_displayed);
+    g_assert_false(frame_data_sequence_find(fds, 6)->dependent_of_displayed);
+
+    free_frame_data_sequence(fds);
+}
+
+/* Conversations with many frames are kept when a bounded table is full */
+void test_conversation_table_topk(void)
+{
+    conv_hash_t ch = { 0 };
+    uint32_t heavy_addr[3] = { 0x0a000001, 0x0a000002, 0x0a000003 };
+    uint32_t server_addr = 0xc0a80001;
+    address server, client;
+    const char *filter;
+    unsigned max_entries;
+
+    set_address(&server, AT_IPv4, 4, &server_addr);
+    ch.max_entries = 4;
+    for (unsigned i = 0; i < 3; i++) {
+        set_address(&client, AT_IPv4, 4, &heavy_addr[i]);
+        add_conversation_table_data(&ch, &client, &server, 1024, 80, 10, 1000, NULL, NULL, NULL, CONVERSATION_TCP);
+    }
+    for (uint32_t i = 0; i < 3000; i++) {
+        uint32_t light_addr = 0x0b000000 + i;
+
+        /* Heavy hitters, in alternating directions */
+        set_address(&client, AT_IPv4, 4, &heavy_addr[i % 3]);
+        if (i % 2) {
+            add_conversation_table_data(&ch, &client, &server, 1024, 80, 1, 100, NULL, NULL, NULL, CONVERSATION_TCP);
+        } else {
+            add_conversation_table_data(&ch, &server, &client, 80, 1024, 1, 100, NULL, NULL, NULL, CONVERSATION_TCP);
+        }
+
+        /* A scan */
+        set_address(&client, AT_IPv4, 4, &light_addr);
+        add_conversation_table_data(&ch, &client, &server, 1024, 80, 1, 60, NULL, NULL, NULL, CONVERSATION_TCP);
+    }
+
+    g_assert_cmpuint(ch.conv_array->len, ==, 4);
+    for (unsigned i = 0; i < 3; i++) {
+        bool found = false;
+        for (unsigned j = 0; j < ch.conv_array->len; j++) {
+            conv_item_t *item = &g_array_index(ch.conv_array, conv_item_t, j);
+            if (item->src_address.len == 4 && memcmp(item->src_address.data, &heavy_addr[i], 4) == 0) {
+                g_assert_false(found);
+                found = true;
+            } else if (item->dst_address.len == 4 && memcmp(item->dst_address.data, &heavy_addr[i], 4) == 0) {
+                g_assert_false(found);
+                found = true;
+            } else {
+                continue;
+            }
+            g_assert_cmpuint(item->rx_frames + item->tx_frames, ==, 1010);
+            g_assert_cmpuint(item->frames_error, ==, 0);
+        }
+        g_assert_true(found);
+    }
+
+    reset_conversation_table_data(&ch);
+    g_assert_null(ch.conv_array);
+    g_assert_null(ch.topk);
+
+    g_assert_true(conversation_table_parse_topk("topk=1000,tcp.port==80", &max_entries, &filter));
+    g_assert_cmpuint(max_entries, ==, 1000);
+    g_assert_cmpstr(filter, ==, "tcp.port==80");
+    g_assert_true(conversation_table_parse_topk("topk=10", &max_entries, &filter));
+    g_assert_cmpuint(max_entries, ==, 10);
+    g_assert_null(filter);
+    g_assert_true(conversation_table_parse_topk("tcp.port==80", &max_entries, &filter));
+    g_assert_cmpuint(max_entries, ==, 0);
+    g_assert_cmpstr(filter, ==, "tcp.port==80");
+    g_assert_true(conversation_table_parse_topk(NULL, &max_entries, &filter));
+    g_assert_null(filter);
+    g_assert_false(conversation_table_parse_topk("topk=0", &max_entries, &filter));
+    g_assert_false(conversation_table_parse_topk("topk=x,tcp", &max_entries, &filter));
+}
+
+typedef struct {
+    const char *name;
+    int id;
+} test_header_t;
+
+/* Some of the names in the HTTP dissector's table */
+static const test_header_t test_headers[] = {
+    { "Authorization", 1 },
+    { "Proxy-Authorization", 2 },
+    { "Proxy-Authenticate", 3 },
+    { "WWW-Authenticate", 4 },
+    { "Content-Type", 5 },
+    { "Content-Length", 6 },
+    { "Content-Encoding", 7 },
+    { "Transfer-Encoding", 8 },
+    { "Upgrade", 9 },
+    { "User-Agent", 10 },
+    { "Host", 11 },
+    { "Range", 12 },
+    { "Content-Range", 13 },
+    { "Connection", 14 },
+    { "Cookie", 15 },
+    { "Accept", 16 },
+    { "Referer", 17 },
+    { "Accept-Language", 18 },
+    { "Accept-Encoding", 19 },
+    { "Date", 20 },
+    { "Cache-Control", 21 },
+    { "Server", 22 },
+    { "Location", 23 },
+    { "Sec-WebSocket-Accept", 24 },
+    { "Sec-WebSocket-Protocol", 25 },
+    { "Sec-WebSocket-Extensions", 26 },
+    { "Set-Cookie", 27 },
+    { "Last-Modified", 28 },
+    { "Expires", 29 },
+    { "HTTP2-Settings", 30 },
+};
+
+/* Header names as they are seen in a browser request, most of them known */
+static const char *test_request_headers[] = {
+    "Host", "Connection", "sec-ch-ua", "sec-ch-ua-mobile", "User-Agent",
+    "Accept", "Sec-Fetch-Site", "Sec-Fetch-Mode", "Sec-Fetch-Dest", "Referer",
+    "Accept-Encoding", "Accept-Language", "Cookie", "If-None-Match",
+    "If-Modified-Since", "content-type", "content-length", "cache-control",
+};
+
+static int
+test_header_linear_lookup(const char *name, size_t len)
+{
+    for (unsigned i = 0; i < array_length(test_headers); i++) {
+        if (len == strlen(test_headers[i].name) &&
+                g_ascii_strncasecmp(test_headers[i].name, name, len) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void test_header_table(void)
+{
+    static const char *names[] = { "Via", NULL, "Max-Forwards", "via", "From" };
+    wmem_allocator_t *scope = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+    header_table_t *table;
+
+    /* Agrees with a linear search, whatever the case */
+    table = HEADER_TABLE_NEW(scope, test_headers, name);
+    for (unsigned i = 0; i < array_length(test_headers); i++) {
+        char *upper = g_ascii_strup(test_headers[i].name, -1);
+
+        g_assert_cmpint(header_table_lookup(table, test_headers[i].name, strlen(test_headers[i].name)), ==, i);
+        g_assert_cmpint(header_table_lookup(table, upper, strlen(upper)), ==, i);
+        g_free(upper);
+    }
+    for (unsigned i = 0; i < array_length(test_request_headers); i++) {
+        const char *name = test_request_headers[i];
+
+        g_assert_cmpint(header_table_lookup(table, name, strlen(name)), ==, test_header_linear_lookup(name, strlen(name)));
+    }
+
+    /* Only the given length is compared */
+    g_assert_cmpint(header_table_lookup(table, "Hostname", 4), ==, 10);
+    g_assert_cmpint(header_table_lookup(table, "Host", 3), ==, -1);
+    g_assert_cmpint(header_table_lookup(table, "", 0), ==, -1);
+
+    /* NULL names are skipped and the first of duplicates wins */
+    table = header_table_new(scope, names, array_length(names), sizeof(names[0]));
+    g_assert_cmpint(header_table_lookup(table, "VIA", 3), ==, 0);
+    g_assert_cmpint(header_table_lookup(table, "max-forwards", 12), ==, 2);
+    g_assert_cmpint(header_table_lookup(table, "From", 4), ==, 4);
+    g_assert_cmpint(header_table_lookup(table, "To", 2), ==, -1);
+
+    wmem_destroy_allocator(scope);
+}
+
+void test_header_table_perf(void)
+{
+    wmem_allocator_t *scope = wmem_allocator_new(WMEM_ALLOCATOR_SIMPLE);
+    header_table_t *table = HEADER_TABLE_NEW(scope, test_headers, name);
+    const int iterations = 1000000;
+    size_t lens[array_length(test_request_headers)];
+    int found = 0;
+
+    for (unsigned i = 0; i < array_length(test_request_headers); i++) {
+        lens[i] = strlen(test_request_headers[i]);
+    }
+
+    g_test_timer_start();
+    for (int i = 0; i < iterations; i++) {
+        unsigned j = i % array_length(test_request_headers);
+        found += test_header_linear_lookup(test_request_headers[j], lens[j]) >= 0;
+    }
+    g_test_minimized_result(g_test_timer_elapsed(), "%d linear lookups in %u names: %f s",
+            iterations, (unsigned)array_length(test_headers), g_test_timer_last());
+
+    g_test_timer_start();
+    for (int i = 0; i < iterations; i++) {
+        unsigned j = i % array_length(test_request_headers);
+        found -= header_table_lookup(table, test_request_headers[j], lens[j]) >= 0;
+    }
+    g_test_minimized_result(g_test_timer_elapsed(), "%d header table lookups in %u names: %f s",
+            iterations, (unsigned)array_length(test_headers), g_test_timer_last());
+    g_assert_cmpint(found, ==, 0);
+
+    wmem_destroy_allocator(scope);
+}
+
+/* Indexed lookups return the same entry as a linear search */
+void test_value_string_index(void)
+{
+    value_string contiguous[33], sorted[33], unsorted[33];
+    value_string_index *vsi;
+
+    for (uint32_t i = 0; i < 32; i++) {
+        contiguous[i].value = i - 4;
+        sorted[i].value = 0xc000 + i * 7;
+        unsorted[i].value = (i * 13) % 20;
+        contiguous[i].strptr = sorted[i].strptr = unsorted[i].strptr = g_strdup_printf("%u", i);
+    }
+    contiguous[32].value = sorted[32].value = unsorted[32].value = 0;
+    contiguous[32].strptr = sorted[32].strptr = unsorted[32].strptr = NULL;
+
+    /* Small tables are searched linearly */
+    g_assert_null(value_string_index_new(&contiguous[32 - 8]));
+
+    for (unsigned t = 0; t < 3; t++) {
+        const value_string *vs = t == 0 ? contiguous : t == 1 ? sorted : unsorted;
+
+        vsi = value_string_index_new(vs);
+        g_assert_nonnull(vsi);
+        g_assert_true(value_string_index_get_vs(vsi) == vs);
+        for (uint32_t val = 0xfffffff0; val != 0x10; val++) {
+            g_assert_true(try_val_to_str_indexed(val, vsi) == try_val_to_str(val, vs));
+        }
+        for (uint32_t val = 0xbff0; val < 0xc100; val++) {
+            g_assert_true(try_val_to_str_indexed(val, vsi) == try_val_to_str(val, vs));
+        }
+        g_assert_true(value_string_index_is_current(vsi));
+        value_string_index_free(vsi);
+    }
+
+    /* Changes to the table are noticed */
+    vsi = value_string_index_new(sorted);
+    sorted[5].value++;
+    g_assert_false(value_string_index_is_current(vsi));
+    sorted[5].value--;
+    g_assert_true(value_string_index_is_current(vsi));
+    sorted[31].strptr = NULL;
+    g_assert_false(value_string_index_is_current(vsi));
+    value_string_index_free(vsi);
+
+    for (unsigned i = 0; i < 32; i++) {
+        g_free((char *)contiguous[i].strptr);
+    }
+}
+
+/*
+ * Lookups in a table like the TLS cipher suites: a few hundred sparse
+ * values, most lookups being for a handful of common ones.
+ */
+void test_value_string_index_perf(void)
+{
+    const unsigned entries = 350;
+    const int iterations = 1000000;
+    static const uint32_t common[] = { 0x1301, 0x1302, 0x1303, 0xc02b, 0xc02f, 0xc030, 0xcca8, 0x009c };
+    value_string *vs = g_new(value_string, entries + 1);
+    value_string_index *vsi;
+    const char *found = NULL;
+
+    for (unsigned i = 0; i < entries; i++) {
+        vs[i].value = i < 200 ? i : 0xc000 + (i - 200) * 3;
+        vs[i].strptr = "TLS_SOME_CIPHER_SUITE";
+    }
+    vs[150].value = 0x1301;
+    vs[151].value = 0x1302;
+    vs[152].value = 0x1303;
+    vs[340].value = 0xcca8;
+    vs[entries].value = 0;
+    vs[entries].strptr = NULL;
+    vsi = value_string_index_new(vs);
+
+    g_test_timer_start();
+    for (int i = 0; i < iterations; i++) {
+        found = try_val_to_str(common[i % array_length(common)], vs);
+    }
+    g_test_minimized_result(g_test_timer_elapsed(), "%d linear lookups in %u entries: %f s",
+            iterations, entries, g_test_timer_last());
+    g_assert_nonnull(found);
+
+    g_test_timer_start();
+    for (int i = 0; i < iterations; i++) {
+        found = try_val_to_str_indexed(common[i % array_length(common)], vsi);
+    }
+    g_test_minimized_result(g_test_timer_elapsed(), "%d indexed lookups in %u entries: %f s",
+            iterations, entries, g_test_timer_last());
+    g_assert_nonnull(found);
+
+    value_string_index_free(vsi);
+    g_free(vs);
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -82,12 +511,26 @@ int main(int argc, char **argv)
 
     g_test_init(&argc, &argv, NULL);
 
+    wmem_init_scopes();
+
     g_test_add_func("/label/strcat", test_label_strcat);
     g_test_add_func("/label/escape_whitespace", test_label_strcat_escape_whitespace);
     g_test_add_func("/label/escape_control", test_label_escape_control);
+    g_test_add_func("/proto_data/basic", test_proto_data);
+    g_test_add_func("/frame_data/dependencies", test_frame_data_dependencies);
+    g_test_add_func("/conversation_table/topk", test_conversation_table_topk);
+    g_test_add_func("/header_table/basic", test_header_table);
+    g_test_add_func("/value_string/index", test_value_string_index);
+    if (g_test_perf()) {
+        g_test_add_func("/proto_data/perf", test_proto_data_perf);
+        g_test_add_func("/header_table/perf", test_header_table_perf);
+        g_test_add_func("/value_string/index_perf", test_value_string_index_perf);
+    }
 
     ret = g_test_run();
 
+    wmem_cleanup_scopes();
+
     return ret;
 }
 
@@ -504,6 +504,197 @@ _try_val_to_str_ext_init(const uint32_t val, value_string_ext *vse)
     return vse->_vs_match2(val, vse);
 }
 
+/* INDEXED VALUE STRING */
+
+/* Indexes are built for plain value_strings that are used often enough,
+ * such as those of registered fields, that a one-off analysis pays for
+ * itself. Like an extended value string, the index uses the fastest access
+ * method the table allows; unlike one, it copes with unsorted tables and
+ * returns the first matching entry, as a linear search would. */
+
+/* Smaller tables are searched linearly */
+#define VS_INDEX_MIN_ENTRIES 16
+
+typedef enum {
+    VS_INDEX_DIRECT,        /* the values are contiguous */
+    VS_INDEX_BSEARCH,       /* the values are in strictly ascending order */
+    VS_INDEX_SORTED         /* a sorted copy of the distinct values is kept */
+} vs_index_type_t;
+
+struct _value_string_index {
+    const value_string *vs;
+    unsigned            num_entries;    /* excluding the final {0, NULL} */
+    uint32_t            first_value;
+    vs_index_type_t     type;
+    uint32_t           *values;         /* VS_INDEX_SORTED: distinct values */
+    unsigned           *entries;        /* VS_INDEX_SORTED: first entry with each value */
+    unsigned            num_values;
+    uint32_t            checksum;       /* of the table, to detect changes */
+};
+
+typedef struct {
+    uint32_t value;
+    unsigned entry;
+} vs_index_pair_t;
+
+static uint32_t
+value_string_checksum(const value_string *vs, unsigned num_entries)
+{
+    uint32_t hash = 2166136261U;
+
+    /* Include the terminator, in case entries are appended */
+    for (unsigned i = 0; i <= num_entries; i++) {
+        hash = (hash ^ vs[i].value) * 16777619U;
+        hash = (hash ^ (uint32_t)(uintptr_t)vs[i].strptr) * 16777619U;
+    }
+    return hash;
+}
+
+static int
+vs_index_pair_compar(const void *a, const void *b)
+{
+    const vs_index_pair_t *pa = (const vs_index_pair_t *)a;
+    const vs_index_pair_t *pb = (const vs_index_pair_t *)b;
+
+    if (pa->value != pb->value)
+        return pa->value > pb->value ? 1 : -1;
+    return pa->entry > pb->entry ? 1 : (pa->entry < pb->entry ? -1 : 0);
+}
+
+value_string_index *
+value_string_index_new(const value_string *vs)
+{
+    value_string_index *vsi;
+    vs_index_pair_t *pairs;
+    unsigned num_entries = 0;
+    bool contiguous = true, ascending = true;
+
+    if (vs == NULL)
+        return NULL;
+
+    while (vs[num_entries].strptr != NULL) {
+        if (num_entries > 0) {
+            if (vs[num_entries].value != vs[0].value + num_entries)
+                contiguous = false;
+            if (vs[num_entries].value <= vs[num_entries - 1].value)
+                ascending = false;
+        }
+        num_entries++;
+    }
+    if (num_entries < VS_INDEX_MIN_ENTRIES)
+        return NULL;
+
+    vsi = g_new0(value_string_index, 1);
+    vsi->vs = vs;
+    vsi->num_entries = num_entries;
+    vsi->first_value = vs[0].value;
+    vsi->checksum = value_string_checksum(vs, num_entries);
+
+    if (contiguous) {
+        vsi->type = VS_INDEX_DIRECT;
+    } else if (ascending) {
+        vsi->type = VS_INDEX_BSEARCH;
+    } else {
+        vsi->type = VS_INDEX_SORTED;
+        pairs = g_new(vs_index_pair_t, num_entries);
+        for (unsigned i = 0; i < num_entries; i++) {
+            pairs[i].value = vs[i].value;
+            pairs[i].entry = i;
+        }
+        qsort(pairs, num_entries, sizeof(pairs[0]), vs_index_pair_compar);
+
+        vsi->values = g_new(uint32_t, num_entries);
+        vsi->entries = g_new(unsigned, num_entries);
+        for (unsigned i = 0; i < num_entries; i++) {
+            /* Duplicates are sorted by entry, so keep the first one */
+            if (vsi->num_values > 0 && vsi->values[vsi->num_values - 1] == pairs[i].value)
+                continue;
+            vsi->values[vsi->num_values] = pairs[i].value;
+            vsi->entries[vsi->num_values] = pairs[i].entry;
+            vsi->num_values++;
+        }
+        g_free(pairs);
+    }
+
+    return vsi;
+}
+
+void
+value_string_index_free(value_string_index *vsi)
+{
+    if (vsi) {
+        g_free(vsi->values);
+        g_free(vsi->entries);
+        g_free(vsi);
+    }
+}
+
+const value_string *
+value_string_index_get_vs(const value_string_index *vsi)
+{
+    return vsi->vs;
+}
+
+bool
+value_string_index_is_current(const value_string_index *vsi)
+{
+    unsigned num_entries = 0;
+
+    while (vsi->vs[num_entries].strptr != NULL && num_entries <= vsi->num_entries)
+        num_entries++;
+
+    return num_entries == vsi->num_entries &&
+           value_string_checksum(vsi->vs, num_entries) == vsi->checksum;
+}
+
+/* Like try_val_to_str for indexed value strings */
+const char *
+try_val_to_str_indexed(const uint32_t val, const value_string_index *vsi)
+{
+    unsigned lo, hi;
+
+    switch (vsi->type) {
+
+    case VS_INDEX_DIRECT:
+        if (val - vsi->first_value < vsi->num_entries)
+            return vsi->vs[val - vsi->first_value].strptr;
+        return NULL;
+
+    case VS_INDEX_BSEARCH:
+        lo = 0;
+        hi = vsi->num_entries;
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+
+            if (vsi->vs[mid].value < val)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < vsi->num_entries && vsi->vs[lo].value == val)
+            return vsi->vs[lo].strptr;
+        return NULL;
+
+    case VS_INDEX_SORTED:
+        lo = 0;
+        hi = vsi->num_values;
+        while (lo < hi) {
+            unsigned mid = lo + (hi - lo) / 2;
+
+            if (vsi->values[mid] < val)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < vsi->num_values && vsi->values[lo] == val)
+            return vsi->vs[vsi->entries[lo]].strptr;
+        return NULL;
+    }
+
+    ws_assert_not_reached();
+    return NULL;
+}
+
 /* EXTENDED 64-BIT VALUE STRING */
 
 /* Extended value strings allow fast(er) val64_string array lookups by
@@ -214,6 +214,35 @@ WS_DLL_PUBLIC
 const char *
 try_val_to_str_idx_ext(const uint32_t val, value_string_ext *vse, int *idx);
 
+/* INDEXED VALUE TO STRING MATCHING */
+
+/* An index built once over a plain value_string, so that frequent lookups
+ * in a large table don't need a linear search. Indexes are built for the
+ * value_strings of registered integer fields. The table must not change
+ * afterwards; value_string_index_is_current() checks that it hasn't. */
+typedef struct _value_string_index value_string_index;
+
+/* Returns NULL if the table is small enough to be searched linearly */
+WS_DLL_PUBLIC
+value_string_index *
+value_string_index_new(const value_string *vs);
+
+WS_DLL_PUBLIC
+void
+value_string_index_free(value_string_index *vsi);
+
+WS_DLL_PUBLIC
+const value_string *
+value_string_index_get_vs(const value_string_index *vsi);
+
+WS_DLL_PUBLIC
+bool
+value_string_index_is_current(const value_string_index *vsi);
+
+WS_DLL_PUBLIC
+const char *
+try_val_to_str_indexed(const uint32_t val, const value_string_index *vsi);
+
 /* EXTENDED 64-BIT VALUE TO STRING MATCHING */
 
 typedef struct _val64_string_ext val64_string_ext;
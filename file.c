@@ -1262,7 +1262,7 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
              * (potentially not displayed) frames.  Find those frames and mark them
              * as depended upon.
              */
-            g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            frame_data_sequence_mark_depended_upon(cf->provider.frames, edt->pi.fd);
         }
     }
 
@@ -5111,6 +5111,11 @@ cf_get_packet_block(capture_file *cf, const frame_data *fd)
         /* rec.block is owned by the record, steal it before it is gone. */
         block = wtap_block_ref(rec.block);
 
+        /* Packets without options may be read without a block; give
+         * the caller one it can add options to. */
+        if (block == NULL && rec.rec_type == REC_TYPE_PACKET)
+            block = wtap_block_create(WTAP_BLOCK_PACKET);
+
         wtap_rec_cleanup(&rec);
         ws_buffer_free(&buf);
         return block;
@@ -98,29 +98,62 @@ Software.
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib.h>
 #include <wsutil/file_util.h>
 
 #include "FuzzerInterface.h"
 
+static void RunOneInput(const char *path) {
+  fprintf(stderr, "Running: %s\n", path);
+  FILE *f = ws_fopen(path, "r");
+  assert(f);
+  fseek(f, 0, SEEK_END);
+  long len = ftell(f);
+  assert(len >= 0);
+  fseek(f, 0, SEEK_SET);
+  unsigned char *buf = (unsigned char*)g_malloc((size_t)len);
+  size_t n_read = fread(buf, 1, len, f);
+  assert(n_read == (size_t)len);
+  fclose(f);
+  LLVMFuzzerTestOneInput(buf, len);
+  g_free(buf);
+  fprintf(stderr, "Done:    %s: (%zd bytes)\n", path, n_read);
+}
+
+static int ComparePaths(const void *a, const void *b) {
+  return strcmp(*(const char * const *)a, *(const char * const *)b);
+}
+
+/* Like libFuzzer, run every file in a directory given as an argument. */
+static void RunDirectory(const char *dirname) {
+  GDir *dir = g_dir_open(dirname, 0, NULL);
+  assert(dir);
+  GPtrArray *paths = g_ptr_array_new_with_free_func(g_free);
+  const char *name;
+  while ((name = g_dir_read_name(dir)) != NULL) {
+    char *path = g_build_filename(dirname, name, NULL);
+    if (g_file_test(path, G_FILE_TEST_IS_REGULAR))
+      g_ptr_array_add(paths, path);
+    else
+      g_free(path);
+  }
+  g_dir_close(dir);
+  /* Sort for a reproducible order. */
+  g_ptr_array_sort(paths, ComparePaths);
+  for (unsigned i = 0; i < paths->len; i++)
+    RunOneInput((const char *)g_ptr_array_index(paths, i));
+  g_ptr_array_free(paths, TRUE);
+}
+
 int main(int argc, char **argv) {
   fprintf(stderr, "StandaloneFuzzTargetMain: running %d inputs\n", argc - 1);
   LLVMFuzzerInitialize(&argc, &argv);
   for (int i = 1; i < argc; i++) {
-    fprintf(stderr, "Running: %s\n", argv[i]);
-    FILE *f = ws_fopen(argv[i], "r");
-    assert(f);
-    fseek(f, 0, SEEK_END);
-    long len = ftell(f);
-    assert(len >= 0);
-    fseek(f, 0, SEEK_SET);
-    unsigned char *buf = (unsigned char*)g_malloc((size_t)len);
-    size_t n_read = fread(buf, 1, len, f);
-    assert(n_read == (size_t)len);
-    fclose(f);
-    LLVMFuzzerTestOneInput(buf, len);
-    g_free(buf);
-    fprintf(stderr, "Done:    %s: (%zd bytes)\n", argv[i], n_read);
+    if (g_file_test(argv[i], G_FILE_TEST_IS_DIR))
+      RunDirectory(argv[i]);
+    else
+      RunOneInput(argv[i]);
   }
 }
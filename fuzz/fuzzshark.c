@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <limits.h>
+#include <errno.h>
 
 #include <glib.h>
 
@@ -23,6 +24,7 @@
 
 #include <wsutil/cmdarg_err.h>
 #include <ui/failure_message.h>
+#include <wsutil/file_util.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/privileges.h>
 #include <wsutil/report_message.h>
@@ -39,6 +41,7 @@
 #include <epan/print.h>
 #include <epan/epan_dissect.h>
 #include <epan/disabled_protos.h>
+#include <epan/proto.h>
 
 #ifdef HAVE_PLUGINS
 #include <wsutil/plugins.h>
@@ -52,6 +55,33 @@ static column_info fuzz_cinfo;
 static epan_t *fuzz_epan;
 static epan_dissect_t *fuzz_edt;
 
+/*
+ * Performance report, enabled with FUZZSHARK_PERF_REPORT=<file>.
+ *
+ * Each input is dissected with a freshly created epan, and its wall time,
+ * number of wmem allocations and number of tree items are written to the
+ * report file. When the process exits, inputs that are much slower than the
+ * rest are listed on stderr as possible performance bugs, together with
+ * the protocols that allocated the most while dissecting them.
+ */
+typedef struct {
+	char    *name;          /* SHA-1 of the input, as used for corpus file names */
+	size_t   len;
+	int64_t  usecs;
+	uint64_t allocations;
+	unsigned tree_items;
+	char    *hotspots;      /* protocols with the most allocations */
+} fuzz_perf_result_t;
+
+/* An input is an outlier if it is this many MADs above the median... */
+#define FUZZ_PERF_OUTLIER_MADS  10
+/* ...and takes at least this long. */
+#define FUZZ_PERF_MIN_USECS     10000
+#define FUZZ_PERF_HOTSPOTS      3
+
+static FILE *fuzz_perf_file;
+static GArray *fuzz_perf_results;
+
 /*
  * Report an error in command-line arguments.
  */
@@ -150,6 +180,162 @@ fuzz_prefs_apply(void)
 	prefs_apply_all();
 }
 
+static void
+fuzz_perf_count_tag(const wmem_tag_stats_t *stats, void *user_data)
+{
+	GHashTable *counts = (GHashTable *)user_data;
+	uint64_t *count;
+
+	count = (uint64_t *)g_hash_table_lookup(counts, stats->tag);
+	if (count == NULL) {
+		count = g_new0(uint64_t, 1);
+		g_hash_table_insert(counts, g_strdup(stats->tag), count);
+	}
+	*count += stats->total_allocations;
+}
+
+/* Returns the total number of allocations per tag, summed over all scopes */
+static GHashTable *
+fuzz_perf_snapshot(void)
+{
+	GHashTable *counts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+	wmem_foreach_tag_stats(fuzz_perf_count_tag, counts);
+	return counts;
+}
+
+typedef struct {
+	const char *tag;
+	uint64_t    allocations;
+} fuzz_perf_hotspot_t;
+
+static int
+fuzz_perf_hotspot_cmp(const void *a, const void *b)
+{
+	const fuzz_perf_hotspot_t *ha = (const fuzz_perf_hotspot_t *)a;
+	const fuzz_perf_hotspot_t *hb = (const fuzz_perf_hotspot_t *)b;
+
+	if (ha->allocations != hb->allocations)
+		return ha->allocations < hb->allocations ? 1 : -1;
+	return strcmp(ha->tag, hb->tag);
+}
+
+/*
+ * Compares two snapshots, returning the total number of allocations made
+ * in between and describing the protocols that made the most in *hotspots.
+ */
+static uint64_t
+fuzz_perf_diff(GHashTable *before, GHashTable *after, char **hotspots)
+{
+	GArray *diffs = g_array_new(false, false, sizeof(fuzz_perf_hotspot_t));
+	GString *str = g_string_new(NULL);
+	GHashTableIter iter;
+	const char *tag;
+	uint64_t *count, *prev;
+	uint64_t total = 0;
+
+	g_hash_table_iter_init(&iter, after);
+	while (g_hash_table_iter_next(&iter, (void **)&tag, (void **)&count)) {
+		fuzz_perf_hotspot_t diff;
+
+		prev = (uint64_t *)g_hash_table_lookup(before, tag);
+		diff.tag = tag;
+		diff.allocations = *count - (prev ? *prev : 0);
+		if (diff.allocations == 0)
+			continue;
+		total += diff.allocations;
+		g_array_append_val(diffs, diff);
+	}
+
+	g_array_sort(diffs, fuzz_perf_hotspot_cmp);
+	for (unsigned i = 0; i < diffs->len && i < FUZZ_PERF_HOTSPOTS; i++) {
+		fuzz_perf_hotspot_t *diff = &g_array_index(diffs, fuzz_perf_hotspot_t, i);
+
+		g_string_append_printf(str, "%s%s:%" PRIu64, i ? "," : "", diff->tag, diff->allocations);
+	}
+	*hotspots = g_string_free(str, false);
+	g_array_free(diffs, true);
+
+	return total;
+}
+
+static int
+fuzz_perf_cmp_usecs(const void *a, const void *b)
+{
+	int64_t ua = *(const int64_t *)a;
+	int64_t ub = *(const int64_t *)b;
+
+	return (ua > ub) - (ua < ub);
+}
+
+static int64_t
+fuzz_perf_median(int64_t *values, unsigned count)
+{
+	qsort(values, count, sizeof(int64_t), fuzz_perf_cmp_usecs);
+	return values[count / 2];
+}
+
+/* Lists the inputs that are much slower than the others */
+static void
+fuzz_perf_report(void)
+{
+	unsigned count = fuzz_perf_results->len;
+	int64_t *values;
+	int64_t median, mad, threshold;
+	unsigned outliers = 0;
+
+	if (fuzz_perf_file) {
+		fclose(fuzz_perf_file);
+		fuzz_perf_file = NULL;
+	}
+
+	if (count == 0)
+		return;
+
+	values = g_new(int64_t, count);
+	for (unsigned i = 0; i < count; i++)
+		values[i] = g_array_index(fuzz_perf_results, fuzz_perf_result_t, i).usecs;
+	median = fuzz_perf_median(values, count);
+	/* The median absolute deviation isn't skewed by the outliers themselves */
+	for (unsigned i = 0; i < count; i++)
+		values[i] = ABS(values[i] - median);
+	mad = fuzz_perf_median(values, count);
+	g_free(values);
+
+	threshold = MAX(median + FUZZ_PERF_OUTLIER_MADS * MAX(mad, 1), FUZZ_PERF_MIN_USECS);
+
+	fprintf(stderr, "oss-fuzzshark: %u inputs, median %" PRId64 " us, MAD %" PRId64 " us\n",
+		count, median, mad);
+	for (unsigned i = 0; i < count; i++) {
+		fuzz_perf_result_t *result = &g_array_index(fuzz_perf_results, fuzz_perf_result_t, i);
+
+		if (result->usecs < threshold)
+			continue;
+		fprintf(stderr, "oss-fuzzshark: possible performance bug: %s (%zu bytes): %" PRId64 " us, "
+			"%" PRIu64 " allocations, %u tree items, most allocations by %s\n",
+			result->name, result->len, result->usecs, result->allocations,
+			result->tree_items, result->hotspots[0] ? result->hotspots : "(none)");
+		outliers++;
+	}
+	if (outliers == 0)
+		fprintf(stderr, "oss-fuzzshark: no performance outliers\n");
+}
+
+static void
+fuzz_perf_init(const char *path)
+{
+	fuzz_perf_file = ws_fopen(path, "w");
+	if (fuzz_perf_file == NULL) {
+		fprintf(stderr, "oss-fuzzshark: can't open %s: %s\n", path, g_strerror(errno));
+		exit(1);
+	}
+	fprintf(fuzz_perf_file, "input\tbytes\tusecs\tallocations\ttree_items\thotspots\n");
+
+	fuzz_perf_results = g_array_new(false, false, sizeof(fuzz_perf_result_t));
+	wmem_set_statistics_enabled(true);
+	atexit(fuzz_perf_report);
+}
+
 static int
 fuzz_init(int argc _U_, char **argv)
 {
@@ -172,6 +358,7 @@ fuzz_init(int argc _U_, char **argv)
 	e_prefs             *prefs_p;
 	int                  ret = EXIT_SUCCESS;
 	size_t               i;
+	const char          *perf_report;
 
 	const char *fuzz_target =
 #if defined(FUZZ_DISSECTOR_TARGET)
@@ -210,6 +397,11 @@ fuzz_init(int argc _U_, char **argv)
 "crash. Mode (2) can be used if a dissector (such as 'ospf') is not available\n"
 "through (1).\n"
 "\n"
+"To look for inputs that are unusually slow to dissect, run a corpus with:\n"
+"      FUZZSHARK_PERF_REPORT=report.tsv FUZZSHARK_TARGET=dns %s corpus-dir\n"
+"    Each input is dissected in a fresh session and its time, allocations and\n"
+"    tree size are written to the report. Outliers are listed on exit.\n"
+"\n"
 "For best results, build dedicated fuzzshark_* targets with:\n"
 "    cmake -GNinja -DCMAKE_C_COMPILER=clang -DCMAKE_CXX_COMPILER=clang++\\\n"
 "      -DENABLE_FUZZER=1 -DENABLE_ASAN=1 -DENABLE_UBSAN=1\n"
@@ -217,7 +409,7 @@ fuzz_init(int argc _U_, char **argv)
 "These options enable LibFuzzer which makes fuzzing possible as opposed to\n"
 "running dissectors only once with a sample (as is the case with this fuzzshark"
 "binary). These fuzzshark_* targets are also used by oss-fuzz.\n",
-			argv[0], argv[0]);
+			argv[0], argv[0], argv[0]);
 		return 1;
 	}
 #endif
@@ -348,6 +540,10 @@ fuzz_init(int argc _U_, char **argv)
 	fuzz_epan = fuzzshark_epan_new();
 	fuzz_edt = epan_dissect_new(fuzz_epan, true, false);
 
+	perf_report = getenv("FUZZSHARK_PERF_REPORT");
+	if (perf_report)
+		fuzz_perf_init(perf_report);
+
 	return 0;
 clean_exit:
 	wtap_cleanup();
@@ -366,6 +562,8 @@ LLVMFuzzerTestOneInput(const uint8_t *buf, size_t real_len)
 
 	wtap_rec rec;
 	frame_data fdlocal;
+	GHashTable *before = NULL;
+	int64_t start = 0;
 
 	memset(&rec, 0, sizeof(rec));
 
@@ -377,11 +575,42 @@ LLVMFuzzerTestOneInput(const uint8_t *buf, size_t real_len)
 	rec.rec_header.packet_header.pkt_encap = INT16_MAX;
 	rec.presence_flags = WTAP_HAS_TS | WTAP_HAS_CAP_LEN; /* most common flags... */
 
+	if (fuzz_perf_results) {
+		/* Start each input from a clean state, so that its cost doesn't
+		 * depend on the inputs before it. */
+		epan_dissect_free(fuzz_edt);
+		epan_free(fuzz_epan);
+		fuzz_epan = fuzzshark_epan_new();
+		fuzz_edt = edt = epan_dissect_new(fuzz_epan, true, false);
+		framenum = 0;
+		before = fuzz_perf_snapshot();
+		start = g_get_monotonic_time();
+	}
+
 	frame_data_init(&fdlocal, ++framenum, &rec, /* offset */ 0, /* cum_bytes */ 0);
 	/* frame_data_set_before_dissect() not needed */
 	epan_dissect_run(edt, WTAP_FILE_TYPE_SUBTYPE_UNKNOWN, &rec, tvb_new_real_data(buf, len, len), &fdlocal, NULL /* &fuzz_cinfo */);
 	frame_data_destroy(&fdlocal);
 
+	if (fuzz_perf_results) {
+		fuzz_perf_result_t result;
+		GHashTable *after;
+
+		result.usecs = g_get_monotonic_time() - start;
+		after = fuzz_perf_snapshot();
+		result.allocations = fuzz_perf_diff(before, after, &result.hotspots);
+		g_hash_table_destroy(before);
+		g_hash_table_destroy(after);
+		result.name = g_compute_checksum_for_data(G_CHECKSUM_SHA1, buf, real_len);
+		result.len = real_len;
+		result.tree_items = edt->tree ? PTREE_DATA(edt->tree)->count : 0;
+		g_array_append_val(fuzz_perf_results, result);
+
+		fprintf(fuzz_perf_file, "%s\t%zu\t%" PRId64 "\t%" PRIu64 "\t%u\t%s\n",
+			result.name, result.len, result.usecs, result.allocations,
+			result.tree_items, result.hotspots);
+	}
+
 	epan_dissect_reset(edt);
 	return 0;
 }
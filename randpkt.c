@@ -101,6 +101,7 @@ usage(bool is_error)
     fprintf(output, "  -F                output file type (default: pcapng)\n");
     fprintf(output, "                    an empty \"-F\" option will list the file types\n");
     fprintf(output, "  -r                select a different random type for each packet\n");
+    fprintf(output, "  -s                random seed, for reproducible output\n");
     fprintf(output, "  -t                packet type\n");
     fprintf(output, "  -h, --help        display this help and exit.\n");
     fprintf(output, "  -v, --version     print version information and exit.\n");
@@ -190,7 +191,7 @@ main(int argc, char *argv[])
 
     ws_init_version_info("Randpkt", NULL, NULL);
 
-    while ((opt = ws_getopt_long(argc, argv, "b:c:F:ht:rv", long_options, NULL)) != -1) {
+    while ((opt = ws_getopt_long(argc, argv, "b:c:F:ht:rs:v", long_options, NULL)) != -1) {
         switch (opt) {
             case 'b':	/* max bytes */
                 produce_max_bytes = get_positive_int(ws_optarg, "max bytes");
@@ -228,6 +229,10 @@ main(int argc, char *argv[])
                 allrandom = true;
                 break;
 
+            case 's':	/* random seed */
+                randpkt_set_seed(get_uint32(ws_optarg, "seed"));
+                break;
+
             case 'v':
                 show_version();
                 goto clean_exit;
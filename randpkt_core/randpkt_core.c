@@ -657,6 +657,17 @@ bool randpkt_example_close(randpkt_example* example)
 	return ok;
 }
 
+void randpkt_set_seed(uint32_t seed)
+{
+	if (pkt_rand != NULL) {
+		g_rand_free(pkt_rand);
+	}
+	pkt_rand = g_rand_new_with_seed(seed);
+
+	/* Used to pick random packet types */
+	g_random_set_seed(seed);
+}
+
 int randpkt_example_init(randpkt_example* example, char* produce_filename, int produce_max_bytes, int file_type_subtype)
 {
 	int err;
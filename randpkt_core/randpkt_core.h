@@ -43,6 +43,9 @@ int randpkt_parse_type(char *string);
 /* Find pkt_example record and return pointer to it */
 randpkt_example* randpkt_find_example(int type);
 
+/* Seed the random number generators, for reproducible output */
+void randpkt_set_seed(uint32_t seed);
+
 /* Init a new example */
 int randpkt_example_init(randpkt_example* example, char* produce_filename, int produce_max_bytes, int file_type_subtype);
 
@@ -291,7 +291,7 @@ process_packet(capture_file *cf, epan_dissect_t *edt,
          */
         if (edt && cf->dfcode) {
             if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->dependent_frames) {
-                g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+                frame_data_sequence_mark_depended_upon(cf->provider.frames, edt->pi.fd);
             }
         }
 
@@ -724,6 +724,11 @@ sharkd_get_packet_block(const frame_data *fd)
         /* rec.block is owned by the record, steal it before it is gone. */
         block = wtap_block_ref(rec.block);
 
+        /* Packets without options may be read without a block; give
+         * the caller one it can add options to. */
+        if (block == NULL && rec.rec_type == REC_TYPE_PACKET)
+            block = wtap_block_create(WTAP_BLOCK_PACKET);
+
         wtap_rec_cleanup(&rec);
         ws_buffer_free(&buf);
         return block;
@@ -1226,6 +1226,19 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
 
 }
 
+static void
+sharkd_session_process_status_wmem(const wmem_tag_stats_t *stats, void *user_data _U_)
+{
+    sharkd_json_object_open(NULL);
+    sharkd_json_value_string("scope", stats->scope);
+    sharkd_json_value_string("tag", stats->tag);
+    sharkd_json_value_anyf("allocs", "%" PRIu64, stats->allocations);
+    sharkd_json_value_anyf("bytes", "%" PRIu64, stats->bytes);
+    sharkd_json_value_anyf("total_allocs", "%" PRIu64, stats->total_allocations);
+    sharkd_json_value_anyf("total_bytes", "%" PRIu64, stats->total_bytes);
+    sharkd_json_object_close();
+}
+
 /**
  * sharkd_session_process_status()
  *
@@ -1242,6 +1255,14 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
  *                      'format'   - column format (%x or %Cus:<expr>:<occurrence> if COL_CUSTOM)
  *                      'visible'  - true if column is visible
  *                      'resolved' - true if column is resolved
+ *   (o) wmem        - array of wmem allocation statistics, when enabled with WIRESHARK_DEBUG_WMEM_STATS,
+ *                     array of object with attributes:
+ *                      'scope'        - memory scope
+ *                      'tag'          - protocol that made the allocations
+ *                      'allocs'       - allocations since the scope was last freed
+ *                      'bytes'        - bytes allocated since the scope was last freed
+ *                      'total_allocs' - allocations since sharkd started
+ *                      'total_bytes'  - bytes allocated since sharkd started
  */
 static void
 sharkd_session_process_status(void)
@@ -1295,6 +1316,13 @@ sharkd_session_process_status(void)
         sharkd_json_array_close();
     }
 
+    if (wmem_statistics_enabled())
+    {
+        sharkd_json_array_open("wmem");
+        wmem_foreach_tag_stats(sharkd_session_process_status_wmem, NULL);
+        sharkd_json_array_close();
+    }
+
     sharkd_json_result_epilogue();
 }
 
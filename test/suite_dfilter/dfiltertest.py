@@ -95,6 +95,24 @@ def checkDFilterCountReadFilter(dfilter_cmd, dfilter_env):
         assert count_output(proc.stdout) == expected_count
     return checkDFilterCount_real
 
+@pytest.fixture
+def checkDFilterCountEarlyExit(cmd_tshark, capture_file, result_file, dfilter_env, request):
+    def checkDFilterCount_real(dfilter, expected_count):
+        """Write the packets matching a display filter with early exit
+        dissection, which needs an output file and a second pass, and expect
+        a certain number of packets."""
+        testout_file = result_file("early_exit.pcapng")
+        subprocesstest.check_run((cmd_tshark, "-n", "-2",
+                                  "-r", capture_file(request.instance.trace_file),
+                                  "-Y", dfilter, "--early-exit", "-w", testout_file),
+                                 env=dfilter_env)
+        proc = subprocesstest.check_run((cmd_tshark, "-n", "-r", testout_file),
+                                         capture_output=True,
+                                         universal_newlines=True,
+                                         env=dfilter_env)
+        assert count_output(proc.stdout) == expected_count
+    return checkDFilterCount_real
+
 @pytest.fixture
 def checkDFilterFail(dftest_cmd, dfilter_env):
     def checkDFilterFail_real(dfilter, error_message):
@@ -111,7 +129,7 @@ def checkDFilterFail(dftest_cmd, dfilter_env):
 
 @pytest.fixture
 def checkDFilterSucceed(dftest_cmd, dfilter_env):
-    def checkDFilterSucceed_real(dfilter, expect_stdout=None):
+    def checkDFilterSucceed_real(dfilter, expect_stdout=None, unexpected_stdout=None):
         """Run a display filter and expect dftest to succeed."""
         proc = subprocesstest.run(dftest_cmd(dfilter),
                                 capture_output=True,
@@ -122,4 +140,6 @@ def checkDFilterSucceed(dftest_cmd, dfilter_env):
         assert proc.returncode == 0
         if expect_stdout:
             assert expect_stdout in proc.stdout
+        if unexpected_stdout:
+            assert unexpected_stdout not in proc.stdout
     return checkDFilterSucceed_real
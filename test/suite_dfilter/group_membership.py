@@ -115,3 +115,35 @@ class TestDfilterMembership:
         dfilter = 'eth.src in {11:12:13:14:15:16, 22-33-}'
         error = 'Error: "22-33-" is not a valid protocol or protocol field.'
         checkDFilterFail(dfilter, error)
+
+    def test_membership_cidr_1(self, checkDFilterCount):
+        dfilter = 'ip.addr in {192.168.0.0/16, 10.0.0.0/24}'
+        checkDFilterCount(dfilter, 1)
+
+    def test_membership_cidr_2(self, checkDFilterCount):
+        dfilter = 'ip.dst in {10.0.0.5, 207.46.0.0/16}'
+        checkDFilterCount(dfilter, 1)
+
+    def test_membership_cidr_3(self, checkDFilterCount):
+        dfilter = 'ip.addr in {192.168.0.0/16, 172.16.0.0/12, 10.0.0.6}'
+        checkDFilterCount(dfilter, 0)
+
+    def test_membership_cidr_all(self, checkDFilterCount):
+        dfilter = 'all ip.addr in {10.0.0.0/8, 207.46.134.94}'
+        checkDFilterCount(dfilter, 1)
+
+    def test_membership_overlapping_ranges(self, checkDFilterCount):
+        dfilter = 'tcp.srcport in {3000..3260, 3250..3266, 3268..4000}'
+        checkDFilterCount(dfilter, 0)
+
+    def test_membership_merged_ranges(self, checkDFilterCount):
+        dfilter = 'tcp.srcport in {3000..3260, 3250..3270, 3500..4000}'
+        checkDFilterCount(dfilter, 1)
+
+    def test_membership_compiled_set(self, checkDFilterSucceed):
+        dfilter = 'tcp.port in {80, 443, 8000..8080}'
+        checkDFilterSucceed(dfilter, '{hash(2) intervals(1)}')
+
+    def test_membership_compiled_cidr(self, checkDFilterSucceed):
+        dfilter = 'ip.addr in {10.0.0.0/8, 192.168.1.0/24, 192.168.2.0/24, 1.2.3.4}'
+        checkDFilterSucceed(dfilter, '{ipv4_prefixes(4/3)}')
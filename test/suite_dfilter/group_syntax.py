@@ -430,6 +430,27 @@ class TestDfilterLayer:
         dfilter = 'ip.dst#[-5] == 2.2.2.2'
         checkDFilterCount(dfilter, 1)
 
+    def test_layer_monotonic_1(self, checkDFilterSucceed):
+        dfilter = 'ip.dst == 8.8.8.8'
+        checkDFilterSucceed(dfilter, 'Monotonic:')
+
+    def test_layer_monotonic_2(self, checkDFilterSucceed):
+        # The last layer so far may not be the last one of the packet.
+        dfilter = 'ip.dst#[-1] == 8.8.8.8'
+        checkDFilterSucceed(dfilter, unexpected_stdout='Monotonic:')
+
+    def test_layer_monotonic_3(self, checkDFilterSucceed):
+        dfilter = 'ip.addr#2 == 4.4.4.4'
+        checkDFilterSucceed(dfilter, unexpected_stdout='Monotonic:')
+
+    def test_layer_early_exit_1(self, checkDFilterCountEarlyExit):
+        dfilter = 'ip.dst#[-1] == 8.8.8.8'
+        checkDFilterCountEarlyExit(dfilter, 0)
+
+    def test_layer_early_exit_2(self, checkDFilterCountEarlyExit):
+        dfilter = 'ip.dst#[-1] == 9.9.9.9'
+        checkDFilterCountEarlyExit(dfilter, 1)
+
 class TestDfilterQuantifiers:
     trace_file = "ipoipoip.pcap"
 
@@ -499,6 +520,60 @@ class TestDfilterXor:
         dfilter = 'ip.src == 9.9.9.9 ^^ ip.dst == 9.9.9.9'
         checkDFilterCount(dfilter, 0)
 
+class TestDfilterOptimizer:
+    trace_file = "http.pcap"
+
+    def test_reorder_1(self, checkDFilterSucceed):
+        # The existence test is cheaper and must run first.
+        dfilter = 'tcp.port == 80 && tcp'
+        checkDFilterSucceed(dfilter, '0000 CHECK_EXISTS')
+
+    def test_reorder_2(self, checkDFilterCount):
+        dfilter = 'http.request.method contains "GE" && tcp.port == 80 && ip'
+        checkDFilterCount(dfilter, 1)
+
+    def test_reorder_3(self, checkDFilterCount):
+        dfilter = 'http.request.method matches "^P" || tcp.port == 80 || ip'
+        checkDFilterCount(dfilter, 1)
+
+    def test_duplicate_1(self, checkDFilterCount):
+        dfilter = 'tcp.port == 80 && tcp.port == 80'
+        checkDFilterCount(dfilter, 1)
+
+    def test_duplicate_2(self, checkDFilterCount):
+        dfilter = 'tcp.port == 81 || (tcp.port == 81 || tcp.port == 81)'
+        checkDFilterCount(dfilter, 0)
+
+    def test_duplicate_3(self, checkDFilterCount):
+        dfilter = '(ip || tcp) && (ip || tcp) && !(ip || tcp)'
+        checkDFilterCount(dfilter, 0)
+
+    def test_duplicate_4(self, checkDFilterCount):
+        # Drops a duplicate before an operand that is kept.
+        dfilter = 'tcp.port == 80 && tcp.port == 80 && ip'
+        checkDFilterCount(dfilter, 1)
+
+    def test_absorb_1(self, checkDFilterSucceed):
+        # (tcp || udp) && tcp == tcp
+        dfilter = '(tcp || udp) && tcp'
+        checkDFilterSucceed(dfilter, '0001 RETURN')
+
+    def test_absorb_2(self, checkDFilterCount):
+        dfilter = 'tcp.port == 80 && (tcp.port == 80 || udp.port == 53)'
+        checkDFilterCount(dfilter, 1)
+
+    def test_absorb_3(self, checkDFilterCount):
+        dfilter = 'tcp.port == 81 || (tcp.port == 81 && ip) || (udp && tcp.port == 81)'
+        checkDFilterCount(dfilter, 0)
+
+    def test_not_not_1(self, checkDFilterCount):
+        dfilter = 'not not tcp.port == 80'
+        checkDFilterCount(dfilter, 1)
+
+    def test_not_not_2(self, checkDFilterCount):
+        dfilter = 'not not not tcp.port == 80'
+        checkDFilterCount(dfilter, 0)
+
 class TestDfilterTFSValueString:
     trace_file = "http.pcap"
 
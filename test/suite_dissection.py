@@ -713,6 +713,45 @@ class TestDissectTcp:
             encoding='utf-8', env=test_env)
         assert stdout == '2\t16\n'
 
+class TestDissectDns:
+    @staticmethod
+    def dns_response(qname, answer_name):
+        '''Returns a DNS response with one question and one A record.'''
+        header = bytes.fromhex('1234 8180 0001 0001 0000 0000')
+        question = qname + bytes.fromhex('0001 0001')
+        answer = answer_name + bytes.fromhex('0001 0001 00000e10 0004 c0000201')
+        return header + question + answer
+
+    @staticmethod
+    def dns_name(*labels):
+        return b''.join(bytes((len(label),)) + label for label in labels) + b'\x00'
+
+    def check_answer_name(self, cmd_tshark, cmd_text2pcap, result_file, test_env, message):
+        hexdump_file = result_file('dns.txt')
+        testout_file = result_file('dns.pcap')
+        with open(hexdump_file, 'w') as f:
+            f.write('0000 ' + message.hex(' ') + '\n')
+        subprocess.check_call((cmd_text2pcap, '-u', '53,53', hexdump_file, testout_file), env=test_env)
+        return subprocess.check_output((cmd_tshark,
+                '-r', testout_file,
+                '-Tfields', '-e', 'dns.resp.name',
+            ), encoding='utf-8', env=test_env).strip()
+
+    def test_dns_bitstring_label_pointer(self, cmd_tshark, cmd_text2pcap, result_file, test_env):
+        '''A bitstring label followed by a pointer to a name seen before.'''
+        message = self.dns_response(self.dns_name(b'example', b'com'),
+                                    bytes.fromhex('41 08 ab c00c'))
+        name = self.check_answer_name(cmd_tshark, cmd_text2pcap, result_file, test_env, message)
+        assert name.endswith('[xab/8].example.com')
+
+    def test_dns_bitstring_labels_pointer_too_long(self, cmd_tshark, cmd_text2pcap, result_file, test_env):
+        '''Bitstring labels followed by a pointer to a long name seen before.'''
+        bitstring = bytes.fromhex('41 ff') + bytes(range(32))
+        message = self.dns_response(self.dns_name(b'a' * 63, b'b' * 63, b'c' * 63, b'com'),
+                                    bitstring * 3 + bytes.fromhex('c00c'))
+        name = self.check_answer_name(cmd_tshark, cmd_text2pcap, result_file, test_env, message)
+        assert name == '<Name too long>'
+
 class TestDissectGit:
     def test_git_prot(self, cmd_tshark, capture_file, features, test_env):
         '''
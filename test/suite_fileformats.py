@@ -106,6 +106,33 @@ class TestFileFormatsPcapng:
             encoding='utf-8', env=test_env)
         assert capture_stdout == fileformats_baseline_str
 
+    def test_pcapng_packet_comments_copy(self, cmd_tshark, cmd_editcap, capture_file, result_file, test_env):
+        '''Packet options are preserved by editcap'''
+        testout_file = result_file('testout.pcapng')
+        subprocess.check_call((cmd_editcap,
+                capture_file('comments.pcapng'), testout_file,
+            ), env=test_env)
+        def comments(filename):
+            return subprocess.check_output((cmd_tshark,
+                    '-r', filename,
+                    '-Tfields', '-e', 'frame.number', '-e', 'frame.comment',
+                ), encoding='utf-8', env=test_env)
+        assert comments(testout_file) == comments(capture_file('comments.pcapng'))
+
+    def test_pcapng_add_packet_comment(self, cmd_tshark, cmd_editcap, capture_file, result_file, test_env):
+        '''Add a comment to a packet read without options'''
+        testout_file = result_file('testout.pcapng')
+        subprocess.check_call((cmd_editcap,
+                '-a', '2:Added comment',
+                capture_file('dhcp.pcapng'), testout_file,
+            ), env=test_env)
+        capture_stdout = subprocess.check_output((cmd_tshark,
+                '-r', testout_file,
+                '-Y', 'frame.comment == "Added comment"',
+                '-Tfields', '-e', 'frame.number',
+            ), encoding='utf-8', env=test_env)
+        assert capture_stdout.split() == ['2']
+
 @pytest.fixture
 def check_pcapng_dsb_fields(request, cmd_tshark):
     '''Factory that checks whether the DSB within the capture file matches.'''
@@ -67,6 +67,44 @@ class TestTsharkIO:
         '''Read direct and write direct using TShark'''
         check_io_4_packets(capture_file, result_file, cmd_tshark, cmd_capinfos, env=test_env)
 
+    @pytest.mark.parametrize('dfilter, count', [
+        ('udp.srcport == 68', 2),
+        ('not udp.srcport == 68', 2),
+        ('udp.srcport == 68 && dhcp.option.dhcp == 3', 1),
+        ('ip.src == 0.0.0.0 || dhcp.option.dhcp == 5', 3),
+    ])
+    def test_tshark_io_early_exit(self, cmd_tshark, cmd_capinfos, capture_file, result_file, test_env, dfilter, count):
+        '''Write filtered packets with early exit dissection using TShark'''
+        testout_file = result_file(testout_pcap)
+        subprocess.check_call((cmd_tshark,
+            '-r', capture_file('dhcp.pcap'),
+            '-2', '-Y', dfilter,
+            '--early-exit',
+            '-w', testout_file,
+        ), env=test_env)
+        check_packet_count(cmd_capinfos, count, testout_file)
+
+    @pytest.mark.parametrize('dfilter', [
+        'frame.len < 150 || http.response.code == 200',
+        'tcp.len < 150 || http.request.method == "GET"',
+    ])
+    def test_tshark_io_early_exit_reassembly(self, cmd_tshark, capture_file, result_file, test_env, dfilter):
+        '''Early exit dissection selects the same packets when TCP reassembles'''
+        def filtered_frames(early_exit, testout_file):
+            subprocess.check_call((cmd_tshark,
+                '-r', capture_file('http-ooo.pcap'),
+                '-2', '-Y', dfilter,
+                *(('--early-exit',) if early_exit else ()),
+                '-w', testout_file,
+            ), env=test_env)
+            return subprocess.check_output((cmd_tshark,
+                '-r', testout_file,
+                '-T', 'fields', '-e', 'frame.time_epoch',
+            ), encoding='utf-8', env=test_env)
+        full = filtered_frames(False, result_file('full.pcap'))
+        assert full
+        assert filtered_frames(True, result_file('early_exit.pcap')) == full
+
 
 class TestRawsharkIO:
     if sys.byteorder != 'little':
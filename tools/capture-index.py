@@ -0,0 +1,600 @@
+#!/usr/bin/env python3
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+'''Build a columnar index of a capture file and filter it with the index.
+
+"build" runs tshark once over a capture file and stores the values of a set
+of fields in blocks of frames, together with per-block min/max zone maps and
+Bloom filters. "query" takes a display filter made of simple comparisons
+joined by "&&", uses the index to find the frames which can match, copies
+only those frames out with editcap, and runs tshark with the full filter on
+the copy. Repeated investigations of a large capture then only dissect the
+frames which are of interest.
+
+Comparisons with ==, <, <=, > and >= of indexed fields with literals
+(quoted strings, numbers and addresses) are evaluated against the index;
+anything else in the filter, including comparisons with other fields and
+with value labels, is left to tshark. The frames are
+renumbered in the copy, and so are the TCP and UDP streams. Comparisons on
+frame.number, tcp.stream and udp.stream are therefore evaluated exactly with
+the index, and replaced with the numbers the matching frames have in the
+copy, before the filter is passed to tshark. Filters which use these or
+other fields that depend on the frames before them (such as relative times)
+in any other way are refused. Frame numbers and stream indexes printed by
+tshark are those of the copy, and PDUs which span frames that were left out
+can't be reassembled.
+
+Examples:
+  capture-index.py build big.pcapng
+  capture-index.py query big.pcapng 'dns.qry.name == "example.com"'
+  capture-index.py query big.pcapng 'tcp.stream == 42 && frame.len > 1000' -- -T fields -e tcp.seq
+  capture-index.py query --frames big.pcapng 'ip.src == 192.0.2.1'
+'''
+
+import argparse
+import base64
+import hashlib
+import ipaddress
+import json
+import os
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import zlib
+
+INDEX_MAGIC = b'WSIDX\x01\n'
+INDEX_SUFFIX = '.wsidx'
+
+DEFAULT_FIELDS = (
+    'frame.number',
+    'frame.time_epoch',
+    'frame.len',
+    'ip.src',
+    'ip.dst',
+    'ipv6.src',
+    'ipv6.dst',
+    'ip.proto',
+    'tcp.srcport',
+    'tcp.dstport',
+    'tcp.stream',
+    'udp.srcport',
+    'udp.dstport',
+    'udp.stream',
+    'dns.qry.name',
+    'http.host',
+    'tls.handshake.extensions_server_name',
+)
+
+# Separates multiple occurrences of a field in the tshark output.
+AGGREGATOR = '\x1f'
+
+BLOOM_BITS_PER_VALUE = 10
+BLOOM_HASHES = 7
+
+# editcap accepts at most this many packet ranges.
+EDITCAP_MAX_SELECTIONS = 512
+
+# Fields whose values depend on the frames before them, and so change when
+# frames are left out of the copy. Comparisons on the ones which are indexed
+# are mapped onto the copy; any other use of them is refused.
+RENUMBERED_FIELDS = (
+    'frame.number',
+    'tcp.stream',
+    'udp.stream',
+)
+RENUMBERED_RE = re.compile(r'(?<![\w.])(?:frame\.number|frame\.time_relative|frame\.time_delta'
+                           r'|frame\.time_delta_displayed|frame\.ref_time|frame\.offset_shift'
+                           r'|tcp\.stream|tcp\.time_relative|tcp\.time_delta'
+                           r'|udp\.stream|udp\.time_relative|udp\.time_delta)(?![\w])')
+
+
+def program(program_path, name):
+    path = os.path.join(program_path, name) if program_path else name
+    if sys.platform == 'win32' and program_path:
+        path += '.exe'
+    return path
+
+
+HEX_BYTES_RE = re.compile(r'^[0-9a-f]{2}(?:[:.-]?[0-9a-f]{2})+$')
+
+
+def canonical(value):
+    '''Returns the form of a value which is stored in the Bloom filters and
+    compared against. The index must never rule out a frame which tshark
+    would match, so numbers, booleans, addresses and byte strings are
+    normalized, and other strings are folded to lower case.'''
+    number = as_number(value)
+    if number is not None:
+        return repr(number)
+    value = value.lower()
+    if value in ('true', 'false'):
+        return repr(int(value == 'true'))
+    try:
+        return str(ipaddress.ip_address(value))
+    except ValueError:
+        pass
+    if HEX_BYTES_RE.match(value):
+        return re.sub(r'[:.-]', '', value)
+    return value
+
+
+def as_number(value):
+    for base in (0, 10):
+        try:
+            return int(value, base)
+        except ValueError:
+            pass
+    try:
+        number = float(value)
+    except ValueError:
+        return None
+    return int(number) if number.is_integer() else number
+
+
+class BloomFilter:
+    def __init__(self, n_bits, bits=None):
+        self.n_bits = n_bits
+        self.bits = bytearray(bits) if bits else bytearray((n_bits + 7) // 8)
+
+    @classmethod
+    def for_values(cls, values):
+        n_bits = max(64, len(values) * BLOOM_BITS_PER_VALUE)
+        bloom = cls(n_bits)
+        for value in values:
+            bloom.add(value)
+        return bloom
+
+    def _positions(self, value):
+        digest = hashlib.blake2b(value.encode('utf-8', 'surrogateescape'), digest_size=16).digest()
+        h1, h2 = struct.unpack('<QQ', digest)
+        for i in range(BLOOM_HASHES):
+            yield (h1 + i * h2) % self.n_bits
+
+    def add(self, value):
+        for pos in self._positions(value):
+            self.bits[pos >> 3] |= 1 << (pos & 7)
+
+    def __contains__(self, value):
+        return all(self.bits[pos >> 3] & (1 << (pos & 7)) for pos in self._positions(value))
+
+    def to_json(self):
+        return [self.n_bits, base64.b64encode(self.bits).decode('ascii')]
+
+    @classmethod
+    def from_json(cls, obj):
+        return cls(obj[0], base64.b64decode(obj[1]))
+
+
+class BlockWriter:
+    '''Accumulates the column values of a block of frames.'''
+    def __init__(self, fields):
+        self.fields = fields
+        self.frames = []
+        self.columns = {field: [] for field in fields}
+
+    def add(self, frame_num, values):
+        self.frames.append(frame_num)
+        for field, value in zip(self.fields, values):
+            self.columns[field].append(value.split(AGGREGATOR) if value else [])
+
+    def metadata(self):
+        '''Returns the zone maps and Bloom filters of the block.'''
+        zones = {}
+        blooms = {}
+        for field, column in self.columns.items():
+            values = set()
+            numbers = []
+            numeric = True
+            for frame_values in column:
+                for value in frame_values:
+                    values.add(canonical(value))
+                    if numeric:
+                        number = as_number(value)
+                        if number is None:
+                            numeric = False
+                        else:
+                            numbers.append(number)
+            if not values:
+                continue
+            if numeric:
+                zones[field] = [min(numbers), max(numbers)]
+            blooms[field] = BloomFilter.for_values(values).to_json()
+        return {
+            'first': self.frames[0],
+            'last': self.frames[-1],
+            'count': len(self.frames),
+            'zones': zones,
+            'blooms': blooms,
+        }
+
+    def data(self):
+        return zlib.compress(json.dumps({
+            'frames': self.frames,
+            'columns': self.columns,
+        }, separators=(',', ':')).encode('utf-8', 'surrogateescape'))
+
+
+def index_path(args):
+    return args.index if args.index else args.capture + INDEX_SUFFIX
+
+
+def build_index(args):
+    fields = list(dict.fromkeys(['frame.number'] + args.fields))
+    cmd = [program(args.program_path, 'tshark'), '-n', '-r', args.capture, '-T', 'fields',
+           '-E', 'separator=/t', '-E', 'occurrence=a', '-E', 'aggregator=' + AGGREGATOR]
+    for field in fields:
+        cmd += ['-e', field]
+    if args.two_pass:
+        cmd.append('-2')
+
+    stat = os.stat(args.capture)
+    blocks = []
+    out_path = index_path(args)
+    tmp_path = out_path + '.tmp'
+
+    with open(tmp_path, 'wb') as out, \
+            subprocess.Popen(cmd, stdout=subprocess.PIPE, encoding='utf-8',
+                             errors='surrogateescape') as proc:
+        out.write(INDEX_MAGIC)
+
+        def flush(block):
+            meta = block.metadata()
+            data = block.data()
+            meta['offset'] = out.tell()
+            meta['length'] = len(data)
+            out.write(data)
+            blocks.append(meta)
+
+        block = BlockWriter(fields)
+        for line in proc.stdout:
+            values = line.rstrip('\n').split('\t')
+            if len(values) != len(fields):
+                continue
+            block.add(int(values[0]), values)
+            if len(block.frames) == args.block_size:
+                flush(block)
+                block = BlockWriter(fields)
+        if block.frames:
+            flush(block)
+
+        if proc.wait() != 0:
+            out.close()
+            os.remove(tmp_path)
+            sys.exit('tshark failed with status %d' % proc.returncode)
+
+        # The metadata goes last, followed by its offset, so that the
+        # blocks can be written as they are filled.
+        footer = zlib.compress(json.dumps({
+            'capture': os.path.abspath(args.capture),
+            'size': stat.st_size,
+            'mtime': stat.st_mtime,
+            'fields': fields,
+            'block_size': args.block_size,
+            'blocks': blocks,
+        }, separators=(',', ':')).encode('utf-8'))
+        footer_offset = out.tell()
+        out.write(footer)
+        out.write(struct.pack('<Q', footer_offset))
+
+    os.replace(tmp_path, out_path)
+    frames = sum(b['count'] for b in blocks)
+    print('Indexed %d frames in %d blocks to %s' % (frames, len(blocks), out_path))
+
+
+class Index:
+    def __init__(self, path, capture):
+        self.f = open(path, 'rb')
+        if self.f.read(len(INDEX_MAGIC)) != INDEX_MAGIC:
+            sys.exit('%s is not a capture index' % path)
+        self.f.seek(-8, os.SEEK_END)
+        end = self.f.tell()
+        (footer_offset,) = struct.unpack('<Q', self.f.read(8))
+        self.f.seek(footer_offset)
+        meta = json.loads(zlib.decompress(self.f.read(end - footer_offset)))
+        stat = os.stat(capture)
+        if stat.st_size != meta['size'] or stat.st_mtime != meta['mtime']:
+            sys.exit('%s has changed since %s was built' % (capture, path))
+        self.fields = meta['fields']
+        self.blocks = meta['blocks']
+        # Fields which only have numeric values. Their values are printed
+        # as numbers, so other literals compared with them may be labels.
+        self.numeric_fields = {field for field in self.fields
+                               if all(field in b['zones'] for b in self.blocks if field in b['blooms'])}
+
+    def block_data(self, block):
+        self.f.seek(block['offset'])
+        return json.loads(zlib.decompress(self.f.read(block['length'])).decode('utf-8', 'surrogateescape'))
+
+
+# A field name, a comparison operator and a literal which may be quoted,
+# optionally in parentheses.
+PREDICATE_RE = re.compile(r'[\s(]*([A-Za-z0-9_][A-Za-z0-9_.-]*)\s*(==|<=|>=|<|>)\s*("(?:[^"\\]|\\.)*"|[^\s"()]+)[\s)]*$')
+QUOTED_RE = re.compile(r'"(?:[^"\\]|\\.)*"')
+
+# Unquoted literals whose value doesn't depend on the type of the field:
+# decimal, hexadecimal and binary integers, floating point numbers, and
+# byte strings and MAC addresses with separators. Integers with a leading
+# zero are octal in display filters, but strings for string fields, so they
+# are left out. Anything else unquoted may be a field, a value_string label
+# or a host name, which only tshark can resolve.
+NUMBER_LITERAL_RE = re.compile(r'^-?(?:0[xX][0-9a-fA-F]+|0[bB][01]+|(?:0|[1-9][0-9]*)(?:\.[0-9]+)?(?:[eE][-+]?[0-9]+)?)$')
+BYTES_LITERAL_RE = re.compile(r'^[0-9a-fA-F]{2}(?:[:.-][0-9a-fA-F]{2})+$')
+
+
+def mask_quoted(display_filter):
+    '''Returns the filter with the contents of strings blanked out, keeping
+    the offsets of everything else.'''
+    return QUOTED_RE.sub(lambda m: '"' + ' ' * (len(m.group(0)) - 2) + '"', display_filter)
+
+
+def decode_string(value):
+    '''Returns the value of the contents of a quoted string, or None if it
+    has escapes for characters that tshark may print differently, such as
+    control characters.'''
+    decoded = ''
+    for m in re.finditer(r'\\(.)|[^\\]+', value):
+        if m.group(1) is None:
+            decoded += m.group(0)
+        elif m.group(1) in '\\"\'':
+            decoded += m.group(1)
+        else:
+            return None
+    return decoded
+
+
+def is_plain_literal(value):
+    '''Returns True if an unquoted value is a literal which means the same
+    whatever the type of the field.'''
+    if NUMBER_LITERAL_RE.match(value) or BYTES_LITERAL_RE.match(value):
+        return True
+    try:
+        ipaddress.ip_address(value)
+    except ValueError:
+        return False
+    return True
+
+
+def parse_filter(display_filter):
+    '''Returns the comparisons in a display filter which the index can
+    evaluate, as (field, operator, value, span) tuples, where span is the
+    position of the comparison in the filter. Raises ValueError if the
+    filter can't be split into conjuncts, as then no part of it can be used
+    to rule frames out.'''
+    masked = mask_quoted(display_filter)
+    if re.search(r'\|\||\^\^|!(?!=)|\b(?:or|xor|not)\b', masked):
+        raise ValueError('only filters joined with "&&" can use the index')
+    predicates = []
+    start = 0
+    for sep in list(re.finditer(r'&&|\band\b', masked)) + [None]:
+        end = sep.start() if sep else len(masked)
+        term_start, start = start, sep.end() if sep else end
+        m = PREDICATE_RE.match(display_filter, term_start, end)
+        if not m:
+            continue
+        field, op, value = m.groups()
+        span = (m.start(1), m.end(3))
+        if value.startswith('"'):
+            value = decode_string(value[1:-1])
+            if value is None:
+                continue
+        elif not is_plain_literal(value):
+            continue
+        if op != '==' and as_number(value) is None:
+            continue
+        predicates.append((field, op, value, span))
+    return predicates
+
+
+def compare(op, a, b):
+    if op == '==':
+        return a == b
+    if op == '<':
+        return a < b
+    if op == '<=':
+        return a <= b
+    if op == '>':
+        return a > b
+    return a >= b
+
+
+def block_may_match(block, field, op, value):
+    if op == '==':
+        bloom = block['blooms'].get(field)
+        return bloom is not None and canonical(value) in BloomFilter.from_json(bloom)
+    zone = block['zones'].get(field)
+    if zone is None:
+        # Either the field isn't in the block, or it has values which
+        # aren't numbers.
+        return field in block['blooms']
+    lo, hi = zone
+    number = as_number(value)
+    if op in ('<', '<='):
+        return compare(op, lo, number)
+    return compare(op, hi, number)
+
+
+def frame_may_match(values, op, value):
+    if op == '==':
+        wanted = canonical(value)
+        return any(canonical(v) == wanted for v in values)
+    number = as_number(value)
+    for v in values:
+        v_number = as_number(v)
+        if v_number is None or compare(op, v_number, number):
+            return True
+    return False
+
+
+def matching_frames(index, predicates):
+    frames = []
+    blocks_read = 0
+    for block in index.blocks:
+        if not all(block_may_match(block, *p) for p in predicates):
+            continue
+        blocks_read += 1
+        data = index.block_data(block)
+        columns = data['columns']
+        for i, frame_num in enumerate(data['frames']):
+            if all(frame_may_match(columns[field][i], op, value) for field, op, value in predicates):
+                frames.append((frame_num, frame_num))
+    return frames, blocks_read
+
+
+def renumbered_predicates(display_filter, predicates):
+    '''Returns the comparisons on renumbered fields, last first. Raises
+    ValueError if the filter uses a renumbered field in any other way.'''
+    renumbered = sorted((p for p in predicates if p[0] in RENUMBERED_FIELDS),
+                        key=lambda p: p[3][0], reverse=True)
+    rest = mask_quoted(display_filter)
+    for predicate in renumbered:
+        start, end = predicate[3]
+        rest = rest[:start] + ' ' * (end - start) + rest[end:]
+    m = RENUMBERED_RE.search(rest)
+    if m:
+        raise ValueError('%s changes in the copy of the matching frames' % m.group(0))
+    return renumbered
+
+
+def frames_in_copy(index, ranges):
+    '''Yields the columns and the row in them of each frame in the copy
+    made of ranges, in the order of the copy.'''
+    ranges = iter(ranges)
+    first, last = next(ranges, (None, None))
+    for block in index.blocks:
+        if first is None:
+            return
+        if block['last'] < first:
+            continue
+        data = index.block_data(block)
+        for i, frame_num in enumerate(data['frames']):
+            while first is not None and frame_num > last:
+                first, last = next(ranges, (None, None))
+            if first is None:
+                return
+            if frame_num >= first:
+                yield data['columns'], i
+
+
+def renumber_filter(index, display_filter, renumbered, ranges):
+    '''Replaces the comparisons on renumbered fields with the numbers which
+    the frames matching them have in the copy made of ranges. The index
+    holds every value of a field, so these comparisons are exact.'''
+    matches = {p: [] for p in renumbered}
+    if renumbered:
+        for copy_num, (columns, i) in enumerate(frames_in_copy(index, ranges), 1):
+            for predicate in renumbered:
+                field, op, value, _ = predicate
+                if frame_may_match(columns[field][i], op, value):
+                    matches[predicate].append(copy_num)
+
+    for predicate in renumbered:
+        numbers = coalesce([(n, n) for n in matches[predicate]], len(matches[predicate]))
+        if numbers:
+            replacement = 'frame.number in {%s}' % ' '.join(
+                str(first) if first == last else '%d..%d' % (first, last) for first, last in numbers)
+        else:
+            # Frames are numbered from 1.
+            replacement = 'frame.number == 0'
+        start, end = predicate[3]
+        display_filter = display_filter[:start] + replacement + display_filter[end:]
+    return display_filter
+
+
+def coalesce(ranges, max_ranges):
+    '''Merges adjacent frame ranges, and then the ranges with the smallest
+    gaps between them until there are at most max_ranges. The result can
+    include frames which don't match, which tshark filters out again.'''
+    merged = []
+    for first, last in ranges:
+        if merged and first <= merged[-1][1] + 1:
+            merged[-1][1] = max(merged[-1][1], last)
+        else:
+            merged.append([first, last])
+    while len(merged) > max_ranges:
+        gaps = sorted(merged[i + 1][0] - merged[i][1] for i in range(len(merged) - 1))
+        threshold = gaps[len(merged) - max_ranges - 1]
+        shrunk = [merged[0]]
+        for r in merged[1:]:
+            if r[0] - shrunk[-1][1] <= threshold:
+                shrunk[-1][1] = r[1]
+            else:
+                shrunk.append(r)
+        merged = shrunk
+    return merged
+
+
+def query_index(args):
+    try:
+        predicates = parse_filter(args.filter)
+    except ValueError as e:
+        sys.exit('%s; run tshark -Y directly' % e)
+
+    index = Index(index_path(args), args.capture)
+    predicates = [p for p in predicates if p[0] in index.fields and
+                  (p[0] not in index.numeric_fields or as_number(p[2]) is not None)]
+    if not predicates:
+        sys.exit('No comparison in the filter uses an indexed field; run tshark -Y directly')
+    if not args.frames:
+        try:
+            renumbered = renumbered_predicates(args.filter, predicates)
+        except ValueError as e:
+            sys.exit('%s; run tshark -Y directly' % e)
+    frames, blocks_read = matching_frames(index, [p[:3] for p in predicates])
+    print('%d of %d blocks read, %d candidate frames' %
+          (blocks_read, len(index.blocks), sum(last - first + 1 for first, last in frames)),
+          file=sys.stderr)
+
+    if args.frames:
+        for first, last in coalesce(frames, len(frames)):
+            print(first if first == last else '%d-%d' % (first, last))
+        return
+    if not frames:
+        return
+
+    ranges = coalesce(frames, EDITCAP_MAX_SELECTIONS)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        subset = os.path.join(tmpdir, 'subset.pcapng')
+        cmd = [program(args.program_path, 'editcap'), '-r', args.capture, subset]
+        cmd += [str(first) if first == last else '%d-%d' % (first, last) for first, last in ranges]
+        subprocess.run(cmd, check=True)
+        display_filter = renumber_filter(index, args.filter, renumbered, ranges)
+        cmd = [program(args.program_path, 'tshark'), '-r', subset, '-Y', display_filter] + args.tshark_args
+        sys.exit(subprocess.run(cmd).returncode)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--program-path', default='',
+                        help='directory containing tshark and editcap (default: search PATH)')
+    parser.add_argument('--index', help='index file (default: the capture file name plus %s)' % INDEX_SUFFIX)
+    subparsers = parser.add_subparsers(dest='command', required=True)
+
+    build = subparsers.add_parser('build', help='index a capture file')
+    build.add_argument('capture')
+    build.add_argument('--fields', type=lambda s: s.split(','), default=list(DEFAULT_FIELDS),
+                       help='comma-separated fields to index')
+    build.add_argument('--block-size', type=int, default=4096, help='frames per block')
+    build.add_argument('--two-pass', action='store_true', help='run a two-pass analysis')
+    build.set_defaults(func=build_index)
+
+    query = subparsers.add_parser('query', help='filter a capture file using its index')
+    query.add_argument('--frames', action='store_true',
+                       help='only print the candidate frame numbers')
+    query.add_argument('capture')
+    query.add_argument('filter')
+    query.add_argument('tshark_args', nargs='*', help='further tshark arguments, after "--"')
+    query.set_defaults(func=query_index)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,481 @@
+#!/usr/bin/env python3
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+'''Generate deterministic capture files for tools/run-benchmarks.py.
+
+Each corpus is synthesized from a fixed seed, so the same arguments always
+produce byte-identical files, and builds can be compared on the same input.
+
+The synthesizers produce well-formed conversations (TCP handshakes with
+consistent sequence numbers, matching requests and responses) for HTTP, DNS,
+TLS, SMB2, QUIC, GTP-U and NGAP. The dns-resolver corpus has large responses
+with heavily compressed names. Random packets from randpkt can be added with
+--randpkt.
+'''
+
+import argparse
+import os
+import random
+import struct
+import subprocess
+import sys
+
+LINKTYPE_ETHERNET = 1
+
+PROTOCOLS = ('http', 'dns', 'dns-resolver', 'tls', 'smb2', 'quic', 'gtp', 'ngap')
+RANDPKT_TYPES = ('dns', 'ip', 'sctp', 'tcp', 'udp')
+
+
+def checksum(data):
+    if len(data) % 2:
+        data += b'\0'
+    total = sum(struct.unpack('!%dH' % (len(data) // 2), data))
+    while total >> 16:
+        total = (total & 0xffff) + (total >> 16)
+    return ~total & 0xffff
+
+
+def ipv4(src, dst, proto, payload, ident=0):
+    header = struct.pack('!BBHHHBBH4s4s', 0x45, 0, 20 + len(payload), ident & 0xffff,
+                         0x4000, 64, proto, 0, src, dst)
+    header = header[:10] + struct.pack('!H', checksum(header)) + header[12:]
+    return header + payload
+
+
+def udp(src, dst, sport, dport, payload, ident=0):
+    # A zero checksum means "not computed" for UDP over IPv4.
+    segment = struct.pack('!HHHH', sport, dport, 8 + len(payload), 0) + payload
+    return ipv4(src, dst, 17, segment, ident)
+
+
+def tcp(src, dst, sport, dport, seq, ack, flags, payload, ident=0):
+    header = struct.pack('!HHIIBBHHH', sport, dport, seq & 0xffffffff, ack & 0xffffffff,
+                         5 << 4, flags, 65535, 0, 0)
+    pseudo = struct.pack('!4s4sBBH', src, dst, 0, 6, len(header) + len(payload))
+    csum = checksum(pseudo + header + payload)
+    header = header[:16] + struct.pack('!H', csum) + header[18:]
+    return ipv4(src, dst, 6, header + payload, ident)
+
+
+def sctp(src, dst, sport, dport, vtag, chunks, ident=0):
+    # The CRC32c checksum isn't verified by default, so it's left as zero.
+    packet = struct.pack('!HHII', sport, dport, vtag, 0) + b''.join(chunks)
+    return ipv4(src, dst, 132, packet, ident)
+
+
+def sctp_data(tsn, stream, ssn, ppid, payload):
+    chunk = struct.pack('!BBHIHHI', 0, 0x03, 16 + len(payload), tsn, stream, ssn, ppid) + payload
+    return chunk + bytes(-len(chunk) % 4)
+
+
+def ethernet(packet, to_server):
+    client = b'\x00\x1b\x21\x0a\x0b\x0c'
+    server = b'\x00\x1c\x42\x0d\x0e\x0f'
+    dst, src = (server, client) if to_server else (client, server)
+    return dst + src + b'\x08\x00' + packet
+
+
+class PcapWriter:
+    '''Writes a pcap file with microsecond timestamps.'''
+
+    def __init__(self, path):
+        self.file = open(path, 'wb')
+        self.file.write(struct.pack('<IHHiIII', 0xa1b2c3d4, 2, 4, 0, 0, 262144, LINKTYPE_ETHERNET))
+        # Fixed start time, 2024-01-01 00:00:00 UTC.
+        self.time_us = 1704067200 * 1000000
+
+    def write(self, frame, delta_us=100):
+        self.time_us += delta_us
+        secs, usecs = divmod(self.time_us, 1000000)
+        self.file.write(struct.pack('<IIII', secs, usecs, len(frame), len(frame)))
+        self.file.write(frame)
+
+    def close(self):
+        self.file.close()
+
+
+class TcpConversation:
+    '''Keeps the sequence numbers of both directions of a connection.'''
+
+    def __init__(self, writer, rng, client, server, sport, dport):
+        self.writer = writer
+        self.client = client
+        self.server = server
+        self.sport = sport
+        self.dport = dport
+        self.seq = [rng.getrandbits(32), rng.getrandbits(32)]
+        self.ident = rng.getrandbits(16)
+
+    def _send(self, to_server, flags, payload=b''):
+        d = 0 if to_server else 1
+        if to_server:
+            pkt = tcp(self.client, self.server, self.sport, self.dport,
+                      self.seq[0], self.seq[1], flags, payload, self.ident)
+        else:
+            pkt = tcp(self.server, self.client, self.dport, self.sport,
+                      self.seq[1], self.seq[0], flags, payload, self.ident)
+        self.ident += 1
+        self.seq[d] += len(payload)
+        if flags & 0x03:  # SYN or FIN
+            self.seq[d] += 1
+        self.writer.write(ethernet(pkt, to_server))
+
+    def open(self):
+        self._send(True, 0x02)
+        self._send(False, 0x12)
+        self._send(True, 0x10)
+
+    def send(self, to_server, payload, mss=1460):
+        for offset in range(0, len(payload), mss):
+            self._send(to_server, 0x18, payload[offset:offset + mss])
+        self._send(not to_server, 0x10)
+
+    def close(self):
+        self._send(True, 0x11)
+        self._send(False, 0x11)
+        self._send(True, 0x10)
+
+
+def random_name(rng, labels=3):
+    return '.'.join(''.join(rng.choice('abcdefghijklmnopqrstuvwxyz')
+                            for _ in range(rng.randint(3, 10)))
+                    for _ in range(labels - 1)) + '.' + rng.choice(('com', 'net', 'org'))
+
+
+def random_host(rng, net):
+    return bytes((net, rng.randint(0, 255), rng.randint(0, 255), rng.randint(1, 254)))
+
+
+def gen_http(writer, rng, count):
+    while count > 0:
+        conv = TcpConversation(writer, rng, random_host(rng, 10), random_host(rng, 192),
+                               rng.randint(1024, 65535), 80)
+        conv.open()
+        for _ in range(rng.randint(1, 4)):
+            host = random_name(rng)
+            path = '/' + '/'.join(random_name(rng, 1).split('.')[0] for _ in range(rng.randint(1, 4)))
+            request = ('GET %s HTTP/1.1\r\nHost: %s\r\nUser-Agent: benchmark\r\n'
+                       'Accept: */*\r\nConnection: keep-alive\r\n\r\n' % (path, host)).encode()
+            body = bytes(rng.getrandbits(8) for _ in range(rng.randint(0, 6000)))
+            response = ('HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n'
+                        'Content-Length: %d\r\n\r\n' % len(body)).encode() + body
+            conv.send(True, request)
+            conv.send(False, response)
+            count -= 4 + len(response) // 1460
+        conv.close()
+        count -= 6
+
+
+def dns_name(name):
+    return b''.join(bytes((len(label),)) + label.encode() for label in name.split('.')) + b'\0'
+
+
+def gen_dns(writer, rng, count):
+    client = random_host(rng, 10)
+    server = bytes((192, 168, 0, 53))
+    for i in range(0, count, 2):
+        txid = rng.getrandbits(16)
+        sport = rng.randint(1024, 65535)
+        qname = dns_name(random_name(rng))
+        qtype = rng.choice((1, 28, 15, 16))
+        query = struct.pack('!HHHHHH', txid, 0x0100, 1, 0, 0, 0) + qname + struct.pack('!HH', qtype, 1)
+        writer.write(ethernet(udp(client, server, sport, 53, query, i), True))
+        answers = b''
+        nanswers = rng.randint(1, 4)
+        for _ in range(nanswers):
+            if qtype == 28:
+                rdata = bytes(rng.getrandbits(8) for _ in range(16))
+            elif qtype == 15:
+                rdata = struct.pack('!H', 10) + b'\xc0\x0c'
+            elif qtype == 16:
+                text = random_name(rng).encode()
+                rdata = bytes((len(text),)) + text
+            else:
+                rdata = random_host(rng, 93)
+            answers += b'\xc0\x0c' + struct.pack('!HHIH', qtype, 1, 300, len(rdata)) + rdata
+        response = (struct.pack('!HHHHHH', txid, 0x8180, 1, nanswers, 0, 0) +
+                    qname + struct.pack('!HH', qtype, 1) + answers)
+        writer.write(ethernet(udp(server, client, 53, sport, response, i), False), 2000)
+
+
+def gen_dns_resolver(writer, rng, count):
+    '''Responses from a recursive resolver: dozens of records per response,
+    with names compressed against a limited set of zones.'''
+    client = random_host(rng, 10)
+    server = bytes((192, 168, 0, 53))
+    zones = [random_name(rng, 2) for _ in range(200)]
+    for i in range(0, count, 2):
+        txid = rng.getrandbits(16)
+        sport = rng.randint(1024, 65535)
+        zone = rng.choice(zones)
+        # The zone starts after the 'www' label of the question, at offset 16.
+        qname = dns_name('www.' + zone)
+        question = qname + struct.pack('!HH', 1, 1)
+        query = struct.pack('!HHHHHH', txid, 0x0100, 1, 0, 0, 0) + question
+        writer.write(ethernet(udp(client, server, sport, 53, query, i), True))
+
+        body = question
+        nanswers = rng.randint(10, 40)
+        for _ in range(nanswers):
+            body += b'\xc0\x0c' + struct.pack('!HHIH', 1, 1, 300, 4) + random_host(rng, 93)
+        # Name servers for the zone, each name a label and a pointer to the zone.
+        nservers = rng.randint(4, 8)
+        ns_offsets = []
+        for n in range(nservers):
+            rdata = dns_name('ns%d' % n)[:-1] + b'\xc0\x10'
+            body += b'\xc0\x10' + struct.pack('!HHIH', 2, 1, 86400, len(rdata))
+            ns_offsets.append(12 + len(body))
+            body += rdata
+        # Their addresses, each name a pointer to a name server name.
+        for ns_offset in ns_offsets:
+            body += struct.pack('!H', 0xc000 | ns_offset) + struct.pack('!HHIH', 1, 1, 86400, 4) + random_host(rng, 198)
+        response = struct.pack('!HHHHHH', txid, 0x8180, 1, nanswers, nservers, nservers) + body
+        writer.write(ethernet(udp(server, client, 53, sport, response, i), False), 2000)
+
+
+def tls_record(content_type, body):
+    return struct.pack('!BHH', content_type, 0x0303, len(body)) + body
+
+
+def tls_handshake(msg_type, body):
+    return struct.pack('!B', msg_type) + struct.pack('!I', len(body))[1:] + body
+
+
+def gen_tls(writer, rng, count):
+    while count > 0:
+        conv = TcpConversation(writer, rng, random_host(rng, 10), random_host(rng, 172),
+                               rng.randint(1024, 65535), 443)
+        conv.open()
+        sni = random_name(rng).encode()
+        server_name = struct.pack('!HBH', len(sni) + 3, 0, len(sni)) + sni
+        extensions = (struct.pack('!HH', 0, len(server_name)) + server_name +
+                      struct.pack('!HHH', 43, 3, 0x0203) + b'\x04')
+        ciphers = struct.pack('!HHHH', 6, 0x1301, 0x1302, 0x1303)
+        hello = (struct.pack('!H', 0x0303) + bytes(rng.getrandbits(8) for _ in range(32)) +
+                 b'\x20' + bytes(rng.getrandbits(8) for _ in range(32)) +
+                 ciphers + b'\x01\x00' + struct.pack('!H', len(extensions)) + extensions)
+        conv.send(True, tls_record(22, tls_handshake(1, hello)))
+        server_hello = (struct.pack('!H', 0x0303) + bytes(rng.getrandbits(8) for _ in range(32)) +
+                        b'\x20' + bytes(rng.getrandbits(8) for _ in range(32)) +
+                        struct.pack('!HB', 0x1301, 0) + struct.pack('!HHHH', 6, 43, 2, 0x0304))
+        conv.send(False, tls_record(22, tls_handshake(2, server_hello)) +
+                  tls_record(20, b'\x01') +
+                  tls_record(23, bytes(rng.getrandbits(8) for _ in range(rng.randint(1000, 4000)))))
+        for _ in range(rng.randint(1, 6)):
+            conv.send(True, tls_record(23, bytes(rng.getrandbits(8) for _ in range(rng.randint(50, 600)))))
+            conv.send(False, tls_record(23, bytes(rng.getrandbits(8) for _ in range(rng.randint(100, 8000)))))
+            count -= 6
+        conv.close()
+        count -= 10
+
+
+def smb2_header(command, message_id, response, session_id=0, tree_id=0):
+    flags = 0x00000001 if response else 0
+    return struct.pack('<4sHHIHHIIQIIQ16s', b'\xfeSMB', 64, 1, 0, command, 1, flags, 0,
+                       message_id, 0, tree_id, session_id, b'\0' * 16)
+
+
+def netbios(payload):
+    return struct.pack('!I', len(payload)) + payload
+
+
+def gen_smb2(writer, rng, count):
+    while count > 0:
+        conv = TcpConversation(writer, rng, random_host(rng, 10), random_host(rng, 172),
+                               rng.randint(1024, 65535), 445)
+        conv.open()
+        dialects = (0x0202, 0x0210, 0x0300, 0x0302)
+        negotiate = (struct.pack('<HHHHI', 36, len(dialects), 1, 0, 0x7f) +
+                     bytes(rng.getrandbits(8) for _ in range(16)) + struct.pack('<Q', 0) +
+                     struct.pack('<%dH' % len(dialects), *dialects))
+        conv.send(True, netbios(smb2_header(0, 0, False) + negotiate))
+        negotiate_response = (struct.pack('<HHH', 65, 1, 0x0302) + struct.pack('<H', 0) +
+                              bytes(rng.getrandbits(8) for _ in range(16)) +
+                              struct.pack('<IIIIQQHHI', 0x7f, 8388608, 8388608, 8388608,
+                                          0, 0, 128, 0, 0))
+        conv.send(False, netbios(smb2_header(0, 0, True) + negotiate_response))
+        session_id = rng.getrandbits(64)
+        tree_id = rng.getrandbits(32)
+        file_id = bytes(rng.getrandbits(8) for _ in range(16))
+        for message_id in range(1, rng.randint(2, 12)):
+            length = rng.randint(512, 8192)
+            read = struct.pack('<HBBIQ16sIIIHH', 49, 0x50, 0, length, message_id * length,
+                               file_id, 1, 0, 0, 0, 0) + b'\0'
+            conv.send(True, netbios(smb2_header(8, message_id, False, session_id, tree_id) + read))
+            data = bytes(rng.getrandbits(8) for _ in range(length))
+            read_response = struct.pack('<HBBIII', 17, 80, 0, length, 0, 0) + data
+            conv.send(False, netbios(smb2_header(8, message_id, True, session_id, tree_id) + read_response))
+            count -= 4 + length // 1460
+        conv.close()
+        count -= 10
+
+
+def quic_varint(value):
+    if value < 0x40:
+        return struct.pack('!B', value)
+    if value < 0x4000:
+        return struct.pack('!H', 0x4000 | value)
+    return struct.pack('!I', 0x80000000 | value)
+
+
+def gen_quic(writer, rng, count):
+    while count > 0:
+        client = random_host(rng, 10)
+        server = random_host(rng, 142)
+        sport = rng.randint(1024, 65535)
+        dcid = bytes(rng.getrandbits(8) for _ in range(8))
+        scid = bytes(rng.getrandbits(8) for _ in range(8))
+        # Initial packets, padded to 1200 bytes as required by RFC 9000.
+        for to_server in (True, False):
+            payload = bytes(rng.getrandbits(8) for _ in range(1162 - len(dcid) - len(scid)))
+            cids = (bytes((len(dcid),)) + dcid + bytes((len(scid),)) + scid) if to_server else \
+                   (bytes((len(scid),)) + scid + bytes((len(dcid),)) + dcid)
+            initial = (b'\xc3' + struct.pack('!I', 1) + cids + quic_varint(0) +
+                       quic_varint(len(payload) + 4) + struct.pack('!I', 0) + payload)
+            if to_server:
+                writer.write(ethernet(udp(client, server, sport, 443, initial), True))
+            else:
+                writer.write(ethernet(udp(server, client, 443, sport, initial), False), 20000)
+        # Short header (1-RTT) packets.
+        for pn in range(rng.randint(4, 40)):
+            to_server = rng.random() < 0.3
+            cid = scid if to_server else dcid
+            payload = bytes(rng.getrandbits(8) for _ in range(rng.randint(40, 1350)))
+            short = b'\x43' + cid + struct.pack('!I', pn) + payload
+            if to_server:
+                writer.write(ethernet(udp(client, server, sport, 443, short), True))
+            else:
+                writer.write(ethernet(udp(server, client, 443, sport, short), False))
+            count -= 1
+        count -= 2
+
+
+def gen_gtp(writer, rng, count):
+    sgw = bytes((10, 255, 0, 1))
+    pgw = bytes((10, 255, 0, 2))
+    teids = [rng.getrandbits(32) for _ in range(64)]
+    for i in range(count):
+        ue = random_host(rng, 100)
+        remote = random_host(rng, 8)
+        inner = udp(ue, remote, rng.randint(1024, 65535), rng.choice((53, 123, 443, 5060)),
+                    bytes(rng.getrandbits(8) for _ in range(rng.randint(20, 1200))), i)
+        gtp = struct.pack('!BBHI', 0x30, 0xff, len(inner), rng.choice(teids)) + inner
+        writer.write(ethernet(udp(sgw, pgw, 2152, 2152, gtp, i), True))
+
+
+def aper_length(length):
+    if length < 128:
+        return struct.pack('!B', length)
+    return struct.pack('!H', 0x8000 | length)
+
+
+def ngap_ie(ie_id, value):
+    # id (0..65535), criticality (reject), open type value
+    return struct.pack('!HB', ie_id, 0) + aper_length(len(value)) + value
+
+
+def ngap_nas_transport(procedure_code, amf_ue_id, ran_ue_id, nas_pdu):
+    '''An APER-encoded DownlinkNASTransport or UplinkNASTransport.'''
+    amf_bytes = (amf_ue_id.bit_length() + 7) // 8 or 1
+    ran_bytes = (ran_ue_id.bit_length() + 7) // 8 or 1
+    ies = [
+        # AMF-UE-NGAP-ID, INTEGER (0..2^40-1): 3-bit length, aligned octets
+        ngap_ie(10, struct.pack('!B', (amf_bytes - 1) << 5) + amf_ue_id.to_bytes(amf_bytes, 'big')),
+        # RAN-UE-NGAP-ID, INTEGER (0..2^32-1): 2-bit length, aligned octets
+        ngap_ie(85, struct.pack('!B', (ran_bytes - 1) << 6) + ran_ue_id.to_bytes(ran_bytes, 'big')),
+        # NAS-PDU, OCTET STRING
+        ngap_ie(38, aper_length(len(nas_pdu)) + nas_pdu),
+    ]
+    # Extensible SEQUENCE with its ProtocolIE-Container of (0..65535) IEs
+    value = b'\x00' + struct.pack('!H', len(ies)) + b''.join(ies)
+    # NGAP-PDU initiatingMessage: procedureCode, criticality (ignore), value
+    return struct.pack('!BBB', 0x00, procedure_code, 0x40) + aper_length(len(value)) + value
+
+
+def gen_ngap(writer, rng, count):
+    '''NAS transport between gNBs and an AMF, with several NGAP messages
+    bundled in each SCTP packet.'''
+    amf = bytes((10, 0, 0, 1))
+    gnbs = [(random_host(rng, 10), rng.getrandbits(32)) for _ in range(16)]
+    tsns = [rng.getrandbits(31) for _ in gnbs]
+    for i in range(count):
+        g = rng.randrange(len(gnbs))
+        gnb, vtag = gnbs[g]
+        uplink = rng.random() < 0.5
+        chunks = []
+        for _ in range(rng.randint(1, 8)):
+            # 5GMM status with a random cause, in a plain 5GS NAS message
+            nas_pdu = b'\x7e\x00\x64' + struct.pack('!B', rng.choice((3, 6, 7, 9, 10, 11, 22, 111)))
+            message = ngap_nas_transport(46 if uplink else 4, rng.getrandbits(rng.choice((8, 24, 40))),
+                                         rng.getrandbits(rng.choice((8, 16, 32))), nas_pdu)
+            chunks.append(sctp_data(tsns[g], 1, tsns[g] & 0xffff, 60, message))
+            tsns[g] = (tsns[g] + 1) & 0xffffffff
+        if uplink:
+            writer.write(ethernet(sctp(gnb, amf, 38412, 38412, vtag, chunks, i), True))
+        else:
+            writer.write(ethernet(sctp(amf, gnb, 38412, 38412, vtag, chunks, i), False))
+
+
+GENERATORS = {
+    'http': gen_http,
+    'dns': gen_dns,
+    'dns-resolver': gen_dns_resolver,
+    'tls': gen_tls,
+    'smb2': gen_smb2,
+    'quic': gen_quic,
+    'gtp': gen_gtp,
+    'ngap': gen_ngap,
+}
+
+
+def corpus_path(directory, name):
+    return os.path.join(directory, 'bench-%s.pcap' % name)
+
+
+def make_corpus(directory, name, packets, seed):
+    path = corpus_path(directory, name)
+    writer = PcapWriter(path)
+    # Each corpus has its own stream, so adding one doesn't change the others.
+    rng = random.Random('%d-%s' % (seed, name))
+    GENERATORS[name](writer, rng, packets)
+    writer.close()
+    return path
+
+
+def make_randpkt_corpus(directory, randpkt, ptype, packets, seed):
+    path = corpus_path(directory, 'randpkt-' + ptype)
+    subprocess.check_call((randpkt, '-s', str(seed), '-F', 'pcap', '-t', ptype,
+                           '-b', '1500', '-c', str(packets), path))
+    return path
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--output-dir', default='.', help='directory for the capture files')
+    parser.add_argument('--packets', type=int, default=20000,
+                        help='approximate number of packets per corpus (default: %(default)s)')
+    parser.add_argument('--seed', type=int, default=1, help='random seed (default: %(default)s)')
+    parser.add_argument('--protocols', default=','.join(PROTOCOLS),
+                        help='comma separated list of corpora (default: %(default)s)')
+    parser.add_argument('--randpkt', metavar='PATH',
+                        help='also generate corpora of random packets with this randpkt executable')
+    args = parser.parse_args()
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    for name in args.protocols.split(','):
+        if name not in GENERATORS:
+            parser.error('unknown corpus "%s"' % name)
+        print(make_corpus(args.output_dir, name, args.packets, args.seed))
+    if args.randpkt:
+        for ptype in RANDPKT_TYPES:
+            print(make_randpkt_corpus(args.output_dir, args.randpkt, ptype, args.packets, args.seed))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+#
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+'''Measure the throughput of tshark, editcap, mergecap and capinfos.
+
+Runs each benchmark on the corpora generated by tools/make-benchmark-corpus.py
+and reports packets/s, bytes/s and peak RSS, the time taken to read each
+primed field of a packet, the throughput of filters using "in" with sets of
+10 to 100000 addresses, and optionally heap allocations per packet (with
+--allocs, which requires Valgrind). The results are written as JSON, so that
+two builds can be compared with --compare.
+
+Examples:
+  run-benchmarks.py --program-path build/run --output new.json
+  run-benchmarks.py --compare old.json new.json
+'''
+
+import argparse
+import glob
+import json
+import os
+import platform
+import re
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+# Fields present in (nearly) every packet of the corpora, for measuring the
+# cost of reading many primed fields.
+MANY_FIELDS = (
+    'frame.number', 'frame.time_epoch', 'frame.time_delta', 'frame.time_relative', 'frame.len',
+    'frame.cap_len', 'frame.protocols', 'frame.marked', 'frame.ignored', 'frame.encap_type',
+    'frame.offset_shift', 'eth.dst', 'eth.src', 'eth.type', 'eth.addr', 'eth.dst.lg', 'eth.dst.ig',
+    'eth.src.lg', 'eth.src.ig', 'ip.version', 'ip.hdr_len', 'ip.dsfield', 'ip.dsfield.dscp',
+    'ip.dsfield.ecn', 'ip.len', 'ip.id', 'ip.flags', 'ip.flags.df', 'ip.flags.mf', 'ip.frag_offset',
+    'ip.ttl', 'ip.proto', 'ip.checksum', 'ip.src', 'ip.dst', 'ip.addr', 'ip.host', 'tcp.srcport',
+    'tcp.dstport', 'tcp.port', 'tcp.stream', 'tcp.len', 'tcp.seq', 'tcp.ack', 'tcp.hdr_len',
+    'tcp.flags', 'tcp.window_size_value', 'tcp.checksum', 'udp.srcport', 'udp.dstport',
+)
+
+# Sizes of the sets of addresses used to measure the "in" operator. The
+# largest set doesn't fit on a Windows command line.
+MEMBERSHIP_SET_SIZES = (10, 1000) if sys.platform == 'win32' else (10, 1000, 100000)
+
+
+def membership_filter(count):
+    '''Returns the arguments of a display filter matching ip.addr against a
+    set of count addresses. tshark joins the arguments that follow the file
+    name into the filter, so the set is split to keep each argument short.'''
+    addresses = ['10.%d.%d.%d' % (i >> 16, (i >> 8) & 0xff, i & 0xff) for i in range(count)]
+    chunks = [', '.join(addresses[i:i + 1000]) for i in range(0, count, 1000)]
+    return ('ip.addr', 'in', '{') + tuple(c + ',' for c in chunks[:-1]) + (chunks[-1], '}')
+
+
+# Name, tshark arguments.
+TSHARK_MODES = (
+    ('summary', ()),
+    ('tree', ('-V',)),
+    ('fields', ('-T', 'fields', '-e', 'frame.number', '-e', 'ip.src', '-e', 'ip.dst',
+                '-e', '_ws.col.protocol')),
+    ('fields-%d' % len(MANY_FIELDS), ('-T', 'fields') + sum((('-e', f) for f in MANY_FIELDS), ())),
+    ('ek', ('-T', 'ek')),
+    ('filter', ('-q', '-Y', 'tcp.port == 443 || dns.qry.name contains "com" || smb2.cmd == 8')),
+    ('two-pass', ('-2', '-q', '-R', 'frame.len > 100')),
+) + tuple(('in-%d' % n, ('-q',) + membership_filter(n)) for n in MEMBERSHIP_SET_SIZES)
+
+
+def program(program_path, name):
+    path = os.path.join(program_path, name)
+    if sys.platform == 'win32':
+        path += '.exe'
+    if not os.path.isfile(path):
+        sys.exit('%s not found' % path)
+    return path
+
+
+def pcap_totals(path):
+    '''Returns the number of packets and captured bytes of a pcap file.'''
+    packets = 0
+    total = 0
+    with open(path, 'rb') as f:
+        magic = f.read(24)[:4]
+        endian = '<' if magic in (b'\xd4\xc3\xb2\xa1', b'\x4d\x3c\xb2\xa1') else '>'
+        while True:
+            header = f.read(16)
+            if len(header) < 16:
+                break
+            caplen = struct.unpack(endian + 'IIII', header)[2]
+            f.seek(caplen, os.SEEK_CUR)
+            packets += 1
+            total += caplen
+    return packets, total
+
+
+def run_timed(command):
+    '''Runs a command with its output discarded and returns the elapsed
+    time in seconds and the peak RSS in bytes, if known.'''
+    start = time.perf_counter()
+    proc = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    if hasattr(os, 'wait4'):
+        _, status, rusage = os.wait4(proc.pid, 0)
+        elapsed = time.perf_counter() - start
+        # ru_maxrss is in kilobytes on Linux and in bytes on macOS.
+        peak_rss = rusage.ru_maxrss if sys.platform == 'darwin' else rusage.ru_maxrss * 1024
+        proc.returncode = os.waitstatus_to_exitcode(status)
+        stderr = proc.stderr.read()
+    else:
+        stderr = proc.communicate()[1]
+        elapsed = time.perf_counter() - start
+        peak_rss = None
+    proc.stderr.close()
+    if proc.returncode != 0:
+        sys.exit('%s failed:\n%s' % (' '.join(command), stderr.decode(errors='replace')))
+    return elapsed, peak_rss
+
+
+def count_allocs(command):
+    '''Returns the total number of heap allocations reported by Valgrind.'''
+    result = subprocess.run(('valgrind', '--tool=memcheck', '--leak-check=no') + tuple(command),
+                            stdout=subprocess.DEVNULL, stderr=subprocess.PIPE,
+                            env=dict(os.environ, G_SLICE='always-malloc'))
+    match = re.search(r'total heap usage: ([\d,]+) allocs', result.stderr.decode(errors='replace'))
+    if not match:
+        return None
+    return int(match.group(1).replace(',', ''))
+
+
+def benchmark(name, command, packets, size, args):
+    times = []
+    peak_rss = None
+    for _ in range(args.repeat):
+        elapsed, rss = run_timed(command)
+        times.append(elapsed)
+        if rss is not None:
+            peak_rss = max(peak_rss or 0, rss)
+    # The fastest run is the least disturbed by the rest of the system.
+    best = min(times)
+    result = {
+        'name': name,
+        'packets': packets,
+        'bytes': size,
+        'seconds': best,
+        'packets_per_second': packets / best if best else None,
+        'bytes_per_second': size / best if best else None,
+        'peak_rss': peak_rss,
+    }
+    if args.allocs:
+        allocs = count_allocs(command)
+        result['allocs_per_packet'] = allocs / packets if allocs is not None and packets else None
+    print('%-32s %10.0f pkts/s %12.0f B/s %8.1f MiB' % (
+        name, result['packets_per_second'] or 0, result['bytes_per_second'] or 0,
+        (peak_rss or 0) / 1048576), flush=True)
+    return result
+
+
+def field_read_cost(by_mode, packets):
+    '''Estimates the cost of reading one primed field of one packet from the
+    difference between the few and the many fields modes.'''
+    mode_args = dict(TSHARK_MODES)
+    few = by_mode['fields']
+    many = by_mode['fields-%d' % len(MANY_FIELDS)]
+    extra_fields = mode_args['fields-%d' % len(MANY_FIELDS)].count('-e') - mode_args['fields'].count('-e')
+    if not packets:
+        return
+    many['field_read_ns'] = (many['seconds'] - few['seconds']) / (packets * extra_fields) * 1e9
+    print('%-32s %10.1f ns/field' % (many['name'], many['field_read_ns']), flush=True)
+
+
+def run(args):
+    tshark = program(args.program_path, 'tshark')
+    editcap = program(args.program_path, 'editcap')
+    mergecap = program(args.program_path, 'mergecap')
+    capinfos = program(args.program_path, 'capinfos')
+
+    corpus_dir = args.corpus_dir or tempfile.mkdtemp(prefix='wireshark-benchmarks-')
+    make_corpus = [sys.executable, os.path.join(os.path.dirname(__file__), 'make-benchmark-corpus.py'),
+                   '--output-dir', corpus_dir, '--packets', str(args.packets), '--seed', str(args.seed)]
+    randpkt = os.path.join(args.program_path, 'randpkt' + ('.exe' if sys.platform == 'win32' else ''))
+    if os.path.isfile(randpkt):
+        make_corpus += ['--randpkt', randpkt]
+    subprocess.check_call(make_corpus, stdout=subprocess.DEVNULL)
+    corpora = sorted(glob.glob(os.path.join(corpus_dir, 'bench-*.pcap')))
+
+    # Don't let the user's profile change what is measured.
+    os.environ['WIRESHARK_CONFIG_DIR'] = tempfile.mkdtemp(prefix='wireshark-benchmarks-config-')
+
+    results = []
+    total_packets = 0
+    total_bytes = 0
+    with tempfile.TemporaryDirectory() as scratch:
+        out_file = os.path.join(scratch, 'out.pcapng')
+        for corpus in corpora:
+            label = os.path.basename(corpus)[len('bench-'):-len('.pcap')]
+            packets, size = pcap_totals(corpus)
+            total_packets += packets
+            total_bytes += size
+            by_mode = {}
+            for mode, mode_args in TSHARK_MODES:
+                by_mode[mode] = benchmark('tshark/%s/%s' % (mode, label),
+                                          (tshark, '-n', '-r', corpus) + mode_args,
+                                          packets, size, args)
+                results.append(by_mode[mode])
+            field_read_cost(by_mode, packets)
+            results.append(benchmark('editcap/%s' % label,
+                                     (editcap, '-F', 'pcapng', corpus, out_file),
+                                     packets, size, args))
+            results.append(benchmark('capinfos/%s' % label,
+                                     (capinfos, corpus), packets, size, args))
+        results.append(benchmark('mergecap/all', [mergecap, '-w', out_file] + corpora,
+                                 total_packets, total_bytes, args))
+
+    report = {
+        'seed': args.seed,
+        'packets': args.packets,
+        'repeat': args.repeat,
+        'platform': platform.platform(),
+        'python': platform.python_version(),
+        'version': subprocess.run((tshark, '--version'), stdout=subprocess.PIPE,
+                                  check=True).stdout.decode(errors='replace').splitlines()[0],
+        'results': results,
+    }
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(report, f, indent=2)
+            f.write('\n')
+    return 0
+
+
+def compare(old_path, new_path):
+    with open(old_path) as f:
+        old = {r['name']: r for r in json.load(f)['results']}
+    with open(new_path) as f:
+        new = {r['name']: r for r in json.load(f)['results']}
+    print('%-32s %12s %12s %8s' % ('benchmark', 'old pkts/s', 'new pkts/s', 'change'))
+    for name, result in new.items():
+        if name not in old or not old[name]['packets_per_second'] or not result['packets_per_second']:
+            continue
+        old_pps = old[name]['packets_per_second']
+        new_pps = result['packets_per_second']
+        print('%-32s %12.0f %12.0f %+7.1f%%' % (name, old_pps, new_pps, (new_pps / old_pps - 1) * 100))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--program-path', default=os.path.join(os.getcwd(), 'run'),
+                        help='directory containing the executables (default: %(default)s)')
+    parser.add_argument('--corpus-dir', help='directory for the generated capture files')
+    parser.add_argument('--packets', type=int, default=20000,
+                        help='approximate number of packets per corpus (default: %(default)s)')
+    parser.add_argument('--seed', type=int, default=1, help='random seed (default: %(default)s)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='number of runs of each benchmark; the fastest is reported (default: %(default)s)')
+    parser.add_argument('--allocs', action='store_true',
+                        help='count heap allocations per packet with Valgrind (slow)')
+    parser.add_argument('--output', metavar='FILE', help='write the results as JSON to FILE')
+    parser.add_argument('--compare', nargs=2, metavar=('OLD', 'NEW'),
+                        help='compare two JSON result files instead of running the benchmarks')
+    args = parser.parse_args()
+
+    if args.compare:
+        return compare(*args.compare)
+    return run(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())
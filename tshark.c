@@ -145,6 +145,7 @@
 #define LONGOPT_PRINT_TIMERS            LONGOPT_BASE_APPLICATION+9
 #define LONGOPT_GLOBAL_PROFILE          LONGOPT_BASE_APPLICATION+10
 #define LONGOPT_COMPRESS                LONGOPT_BASE_APPLICATION+11
+#define LONGOPT_EARLY_EXIT              LONGOPT_BASE_APPLICATION+12
 
 capture_file cfile;
 
@@ -270,6 +271,7 @@ static void tshark_cmdarg_err_cont(const char *msg_format, va_list ap);
 static GHashTable *output_only_tables;
 
 static bool opt_print_timers;
+static bool opt_early_exit;
 struct elapsed_pass_s {
     int64_t dissect;
     int64_t dfilter_read;
@@ -596,6 +598,9 @@ print_usage(FILE *output)
     fprintf(output, "  --temp-dir <directory>   write temporary files to this directory\n");
     fprintf(output, "                           (default: %s)\n", g_get_tmp_dir());
     fprintf(output, "  --compress <type>        compress the output file using the type compression format\n");
+    fprintf(output, "  --early-exit             stop dissecting a packet once the display filter result\n");
+    fprintf(output, "                           is known, in the second pass (-2) when only the\n");
+    fprintf(output, "                           filter result is used\n");
     fprintf(output, "\n");
 
     ws_log_print_usage(output);
@@ -898,6 +903,21 @@ must_do_dissection(dfilter_t *rfcode, dfilter_t *dfcode,
         tap_listeners_require_dissection();
 }
 
+/*
+ * Returns true if dissection of a packet can stop as soon as the outcome
+ * of the display filter is known, because nothing else uses the protocol
+ * tree or the columns (e.g. "-2 -Y <filter> -w <outfile>"). Only the second
+ * pass stops early; the first pass builds the state kept across packets.
+ */
+static bool
+can_exit_dissection_early(capture_file *cf)
+{
+    return opt_early_exit && cf->dfcode && !print_packet_info &&
+        !tap_listeners_require_dissection() && !postdissectors_want_hfids() &&
+        !have_custom_cols(&cf->cinfo) && !dissect_color &&
+        !dfilter_requires_columns(cf->dfcode);
+}
+
 #ifdef HAVE_LIBPCAP
 /*
  * Check whether a purported *shark packet-matching expression (display
@@ -981,6 +1001,7 @@ main(int argc, char *argv[])
         {"print-timers", ws_no_argument, NULL, LONGOPT_PRINT_TIMERS},
         {"global-profile", ws_no_argument, NULL, LONGOPT_GLOBAL_PROFILE},
         {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+        {"early-exit", ws_no_argument, NULL, LONGOPT_EARLY_EXIT},
         {0, 0, 0, 0}
     };
     bool                 arg_error = false;
@@ -1926,6 +1947,9 @@ main(int argc, char *argv[])
             case LONGOPT_PRINT_TIMERS:
                 opt_print_timers = true;
                 break;
+            case LONGOPT_EARLY_EXIT:
+                opt_early_exit = true;
+                break;
             case LONGOPT_GLOBAL_PROFILE:
                 /* already processed; just ignore it now */
                 break;
@@ -3463,7 +3487,7 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
         if (edt && cf->dfcode) {
             elapsed_start = g_get_monotonic_time();
             if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->dependent_frames) {
-                g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+                frame_data_sequence_mark_depended_upon(cf->provider.frames, edt->pi.fd);
             }
 
             if (selected_frame_number != 0 && selected_frame_number == cf->count + 1) {
@@ -3654,6 +3678,9 @@ process_packet_second_pass(capture_file *cf, epan_dissect_t *edt,
         if (cf->dfcode)
             epan_dissect_prime_with_dfilter(edt, cf->dfcode);
 
+        if (can_exit_dissection_early(cf))
+            epan_dissect_set_early_exit(edt, cf->dfcode);
+
         col_custom_prime_edt(edt, &cf->cinfo);
 
         output_fields_prime_edt(edt, output_fields);
@@ -40,9 +40,13 @@ endpoints_draw(void *arg)
 	printf("================================================================================\n");
 	printf("%s Endpoints\n", iu->type);
 	printf("Filter:%s\n", iu->filter ? iu->filter : "<No Filter>");
+	if (iu->hash.max_entries) {
+		printf("Approximate: the top %u endpoints by packets\n", iu->hash.max_entries);
+	}
 
-	printf("                       |  %sPackets  | |  Bytes  | | Tx Packets | | Tx Bytes | | Rx Packets | | Rx Bytes |\n",
-		display_port ? "Port  ||  " : "");
+	printf("                       |  %sPackets  | |  Bytes  | | Tx Packets | | Tx Bytes | | Rx Packets | | Rx Bytes |%s\n",
+		display_port ? "Port  ||  " : "",
+		iu->hash.max_entries ? " |   Error    |" : "");
 
 	max_frames = UINT_MAX;
 	do {
@@ -73,7 +77,7 @@ endpoints_draw(void *arg)
 					port_str = get_endpoint_port(NULL, endpoint, true);
 					printf("%-20s      %5s     %6" PRIu64 "     %9" PRIu64
 					       "     %6" PRIu64 "       %9" PRIu64 "      %6"
-					       PRIu64 "       %9" PRIu64 "   \n",
+					       PRIu64 "       %9" PRIu64 "   ",
 						conversation_str,
 						port_str,
 						endpoint->tx_frames+endpoint->rx_frames, endpoint->tx_bytes+endpoint->rx_bytes,
@@ -83,7 +87,7 @@ endpoints_draw(void *arg)
 				} else {
 					printf("%-20s      %6" PRIu64 "     %9" PRIu64
 					       "     %6" PRIu64 "       %9" PRIu64 "      %6"
-					       PRIu64 "       %9" PRIu64 "   \n",
+					       PRIu64 "       %9" PRIu64 "   ",
 						/* XXX - TODO: make name resolution configurable (through gbl_resolv_flags?) */
 						conversation_str,
 						endpoint->tx_frames+endpoint->rx_frames, endpoint->tx_bytes+endpoint->rx_bytes,
@@ -91,6 +95,11 @@ endpoints_draw(void *arg)
 						endpoint->rx_frames, endpoint->rx_bytes);
 
 				}
+				if (iu->hash.max_entries) {
+					/* As wide as the " |   Error    |" header */
+					printf(" %14" PRIu64, endpoint->frames_error);
+				}
+				printf("\n");
 				wmem_free(NULL, conversation_str);
 			}
 		}
@@ -103,11 +112,18 @@ void init_endpoints(struct register_ct *ct, const char *filter)
 {
 	endpoints_t *iu;
 	GString *error_string;
+	unsigned max_entries;
+
+	if (!conversation_table_parse_topk(filter, &max_entries, &filter)) {
+		cmdarg_err("Invalid \"topk=\" value for endpoint tap: %s", filter);
+		exit(1);
+	}
 
 	iu = g_new0(endpoints_t, 1);
 	iu->type = proto_get_protocol_short_name(find_protocol_by_id(get_conversation_proto_id(ct)));
 	iu->filter = g_strdup(filter);
 	iu->hash.user_data = iu;
+	iu->hash.max_entries = max_entries;
 
 	error_string = register_tap_listener(proto_get_protocol_filter_name(get_conversation_proto_id(ct)), &iu->hash, filter, 0, NULL, get_endpoint_packet_func(ct), endpoints_draw, NULL);
 	if (error_string) {
@@ -20,17 +20,42 @@
 #include <wsutil/file_util.h>
 #include <wsutil/filesystem.h>
 #include <wsutil/cmdarg_err.h>
+#include <wsutil/report_message.h>
 
 #include <epan/packet_info.h>
 #include <epan/packet.h>
 #include <epan/export_object.h>
 #include "tap-exportobject.h"
 
+/* Objects of protocols whose entries are complete when added are saved as
+ * they are added, by a few threads so that tapping isn't held up by disk
+ * writes. At most EO_WRITER_MAX_PENDING objects are kept in memory waiting
+ * to be written, which bounds memory use however many objects there are.
+ * Errors can only be reported from the main thread, so the writer threads
+ * keep them until the pool is joined.
+ */
+#define EO_WRITER_THREADS       4
+#define EO_WRITER_MAX_PENDING   64
+
 typedef struct _export_object_list_gui_t {
-    GSList *entries;
+    GPtrArray *entries;
     register_eo_t* eo;
+    const char *save_in_path;
+    int save_dir_status;        /* 0 = not created yet, 1 = ready, -1 = failed */
+    GThreadPool *writer_pool;
+    GMutex writer_mutex;
+    GCond writer_cond;
+    unsigned writer_pending;
+    GSList *write_failures;     /* eo_write_task_t, most recent first */
 } export_object_list_gui_t;
 
+typedef struct _eo_write_task_t {
+    char *save_as_fullpath;
+    export_object_entry_t *entry;
+    int err;
+    bool open_failed;
+} eo_write_task_t;
+
 static GHashTable* eo_opts;
 
 static bool
@@ -82,19 +107,143 @@ bool eo_tap_opt_add(const char *option_string)
     return false;
 }
 
+static bool
+eo_make_save_dir(export_object_list_gui_t *object_list)
+{
+    if (object_list->save_dir_status == 0) {
+        object_list->save_dir_status = 1;
+        if (!g_file_test(object_list->save_in_path, G_FILE_TEST_IS_DIR)) {
+            /* If the destination directory (or its parents) do not exist, create them. */
+            if (g_mkdir_with_parents(object_list->save_in_path, 0755) == -1) {
+                fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
+                        object_list->save_in_path, g_strerror(errno));
+                object_list->save_dir_status = -1;
+            }
+        }
+    }
+    return object_list->save_dir_status == 1;
+}
+
+/* Returns a g_malloc'd path, in the destination directory, for an
+ * object that isn't the path of an existing file. */
+static char *
+eo_save_as_path(export_object_list_gui_t *object_list, export_object_entry_t *entry)
+{
+    GString *safe_filename = NULL;
+    char *save_as_fullpath = NULL;
+    unsigned count = 0;
+
+    do {
+        g_free(save_as_fullpath);
+        if (entry->filename) {
+            safe_filename = eo_massage_str(entry->filename,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        } else {
+            char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
+            const char *ext;
+            ext = eo_ct2ext(entry->content_type);
+            snprintf(generic_name, sizeof(generic_name),
+                "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
+            safe_filename = eo_massage_str(generic_name,
+                EXPORT_OBJECT_MAXFILELEN, count);
+        }
+        save_as_fullpath = g_build_filename(object_list->save_in_path, safe_filename->str, NULL);
+        g_string_free(safe_filename, TRUE);
+    } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < prefs.gui_max_export_objects);
+
+    return save_as_fullpath;
+}
+
+static void
+eo_write_thread(void *data, void *user_data)
+{
+    eo_write_task_t *task = (eo_write_task_t *)data;
+    export_object_list_gui_t *object_list = (export_object_list_gui_t *)user_data;
+    bool written;
+
+    written = write_file_binary_mode_err(task->save_as_fullpath,
+                                         task->entry->payload_data, task->entry->payload_len,
+                                         &task->err, &task->open_failed);
+    eo_free_entry(task->entry);
+    task->entry = NULL;
+    if (written) {
+        g_free(task->save_as_fullpath);
+        g_free(task);
+    }
+
+    g_mutex_lock(&object_list->writer_mutex);
+    if (!written) {
+        object_list->write_failures = g_slist_prepend(object_list->write_failures, task);
+    }
+    object_list->writer_pending--;
+    g_cond_signal(&object_list->writer_cond);
+    g_mutex_unlock(&object_list->writer_mutex);
+}
+
+/* Hands an object over to the writer threads, waiting if too many
+ * are already waiting to be written. */
+static void
+eo_write_entry_async(export_object_list_gui_t *object_list, export_object_entry_t *entry)
+{
+    eo_write_task_t *task;
+
+    if (object_list->writer_pool == NULL) {
+        g_mutex_init(&object_list->writer_mutex);
+        g_cond_init(&object_list->writer_cond);
+        object_list->writer_pool = g_thread_pool_new(eo_write_thread, object_list,
+                                                     EO_WRITER_THREADS, false, NULL);
+    }
+
+    task = g_new0(eo_write_task_t, 1);
+    task->save_as_fullpath = eo_save_as_path(object_list, entry);
+    task->entry = entry;
+
+    /* Create the file now, so that later objects with the same name
+     * get a different one even if this one hasn't been written yet. */
+    if (!write_file_binary_mode(task->save_as_fullpath, NULL, 0)) {
+        g_free(task->save_as_fullpath);
+        g_free(task);
+        eo_free_entry(entry);
+        return;
+    }
+
+    g_mutex_lock(&object_list->writer_mutex);
+    while (object_list->writer_pending >= EO_WRITER_MAX_PENDING) {
+        g_cond_wait(&object_list->writer_cond, &object_list->writer_mutex);
+    }
+    object_list->writer_pending++;
+    g_mutex_unlock(&object_list->writer_mutex);
+
+    g_thread_pool_push(object_list->writer_pool, task, NULL);
+}
+
 static void
 object_list_add_entry(void *gui_data, export_object_entry_t *entry)
 {
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)gui_data;
 
-    object_list->entries = g_slist_append(object_list->entries, entry);
+    if (get_eo_entries_complete(object_list->eo)) {
+        /* Save it now rather than keeping it until the end. */
+        if (eo_make_save_dir(object_list)) {
+            eo_write_entry_async(object_list, entry);
+        } else {
+            eo_free_entry(entry);
+        }
+        return;
+    }
+
+    g_ptr_array_add(object_list->entries, entry);
 }
 
 static export_object_entry_t*
 object_list_get_entry(void *gui_data, int row) {
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)gui_data;
 
-    return (export_object_entry_t *)g_slist_nth_data(object_list->entries, row);
+    /* Not called for protocols whose entries are complete when added */
+    if (row < 0 || (unsigned)row >= object_list->entries->len) {
+        return NULL;
+    }
+    return (export_object_entry_t *)g_ptr_array_index(object_list->entries, row);
 }
 
 /* This is just for writing Exported Objects to a file */
@@ -103,46 +252,41 @@ eo_draw(void *tapdata)
 {
     export_object_list_t *tap_object = (export_object_list_t *)tapdata;
     export_object_list_gui_t *object_list = (export_object_list_gui_t*)tap_object->gui_data;
-    GSList *slist = object_list->entries;
     export_object_entry_t *entry;
-    char* save_in_path = (char*)g_hash_table_lookup(eo_opts, proto_get_protocol_filter_name(get_eo_proto_id(object_list->eo)));
-    GString *safe_filename = NULL;
-    char *save_as_fullpath = NULL;
-    unsigned count = 0;
+    char *save_as_fullpath;
 
-    if (!g_file_test(save_in_path, G_FILE_TEST_IS_DIR)) {
-        /* If the destination directory (or its parents) do not exist, create them. */
-        if (g_mkdir_with_parents(save_in_path, 0755) == -1) {
-            fprintf(stderr, "Failed to create export objects output directory \"%s\": %s\n",
-                    save_in_path, g_strerror(errno));
-            return;
-        }
-    }
+    if (object_list->writer_pool != NULL) {
+        /* Wait for the objects saved during the tap to be written. */
+        g_thread_pool_free(object_list->writer_pool, false, true);
+        object_list->writer_pool = NULL;
+        g_mutex_clear(&object_list->writer_mutex);
+        g_cond_clear(&object_list->writer_cond);
 
-    while (slist) {
-        entry = (export_object_entry_t *)slist->data;
-        do {
-            g_free(save_as_fullpath);
-            if (entry->filename) {
-                safe_filename = eo_massage_str(entry->filename,
-                    EXPORT_OBJECT_MAXFILELEN, count);
+        object_list->write_failures = g_slist_reverse(object_list->write_failures);
+        for (GSList *item = object_list->write_failures; item; item = item->next) {
+            eo_write_task_t *task = (eo_write_task_t *)item->data;
+
+            if (task->open_failed) {
+                report_open_failure(task->save_as_fullpath, task->err, true);
             } else {
-                char generic_name[EXPORT_OBJECT_MAXFILELEN+1];
-                const char *ext;
-                ext = eo_ct2ext(entry->content_type);
-                snprintf(generic_name, sizeof(generic_name),
-                    "object%u%s%s", entry->pkt_num, ext ? "." : "", ext ? ext : "");
-                safe_filename = eo_massage_str(generic_name,
-                    EXPORT_OBJECT_MAXFILELEN, count);
+                report_write_failure(task->save_as_fullpath, task->err);
             }
-            save_as_fullpath = g_build_filename(save_in_path, safe_filename->str, NULL);
-            g_string_free(safe_filename, TRUE);
-        } while (g_file_test(save_as_fullpath, G_FILE_TEST_EXISTS) && ++count < prefs.gui_max_export_objects);
-        count = 0;
+            g_free(task->save_as_fullpath);
+            g_free(task);
+        }
+        g_slist_free(object_list->write_failures);
+        object_list->write_failures = NULL;
+    }
+
+    if (!eo_make_save_dir(object_list)) {
+        return;
+    }
+
+    for (unsigned i = 0; i < object_list->entries->len; i++) {
+        entry = (export_object_entry_t *)g_ptr_array_index(object_list->entries, i);
+        save_as_fullpath = eo_save_as_path(object_list, entry);
         write_file_binary_mode(save_as_fullpath, entry->payload_data, entry->payload_len);
         g_free(save_as_fullpath);
-        save_as_fullpath = NULL;
-        slist = slist->next;
     }
 }
 
@@ -169,6 +313,8 @@ exportobject_handler(void *key, void *value _U_, void *user_data _U_)
     tap_data->gui_data = (void*)object_list;
 
     object_list->eo = eo;
+    object_list->entries = g_ptr_array_new();
+    object_list->save_in_path = (const char*)g_hash_table_lookup(eo_opts, (const char*)key);
 
     /* Data will be gathered via a tap callback */
     error_msg = register_tap_listener(get_eo_tap_listener_name(eo), tap_data, NULL, 0,
@@ -177,6 +323,7 @@ exportobject_handler(void *key, void *value _U_, void *user_data _U_)
     if (error_msg) {
         cmdarg_err("Can't register %s tap: %s", (const char*)key, error_msg->str);
         g_string_free(error_msg, TRUE);
+        g_ptr_array_free(object_list->entries, TRUE);
         g_free(tap_data);
         g_free(object_list);
         return;
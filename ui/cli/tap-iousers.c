@@ -36,41 +36,46 @@ iousers_draw(void *arg)
 	struct tm * tm_time;
 	unsigned i;
 	bool display_ports = (!strncmp(iu->type, "TCP", 3) || !strncmp(iu->type, "UDP", 3) || !strncmp(iu->type, "SCTP", 4)) ? true : false;
+	const char *error_header1 = iu->hash.max_entries ? "    Error    |" : "";
+	const char *error_header2 = iu->hash.max_entries ? "    Frames   |" : "";
 
 	printf("================================================================================\n");
 	printf("%s Conversations\n", iu->type);
 	printf("Filter:%s\n", iu->filter ? iu->filter : "<No Filter>");
+	if (iu->hash.max_entries) {
+		printf("Approximate: the top %u conversations by frames\n", iu->hash.max_entries);
+	}
 
 	switch (timestamp_get_type()) {
 	case TS_ABSOLUTE:
 	case TS_UTC:
-		printf("%s                                               |       <-      | |       ->      | |     Total     | Absolute Time  |   Duration   |\n",
-			display_ports ? "            " : "");
-		printf("%s                                               | Frames  Size  | | Frames  Size  | | Frames  Size  |      Start     |              |\n",
-			display_ports ? "            " : "");
+		printf("%s                                               |       <-      | |       ->      | |     Total     | Absolute Time  |   Duration   |%s\n",
+			display_ports ? "            " : "", error_header1);
+		printf("%s                                               | Frames  Size  | | Frames  Size  | | Frames  Size  |      Start     |              |%s\n",
+			display_ports ? "            " : "", error_header2);
 		break;
 	case TS_ABSOLUTE_WITH_YMD:
 	case TS_ABSOLUTE_WITH_YDOY:
 	case TS_UTC_WITH_YMD:
 	case TS_UTC_WITH_YDOY:
-		printf("%s                                               |       <-      | |       ->      | |     Total     | Absolute Date  |   Duration   |\n",
-			display_ports ? "            " : "");
-		printf("%s                                               | Frames  Size  | | Frames  Size  | | Frames  Size  |     Start      |              |\n",
-			display_ports ? "            " : "");
+		printf("%s                                               |       <-      | |       ->      | |     Total     | Absolute Date  |   Duration   |%s\n",
+			display_ports ? "            " : "", error_header1);
+		printf("%s                                               | Frames  Size  | | Frames  Size  | | Frames  Size  |     Start      |              |%s\n",
+			display_ports ? "            " : "", error_header2);
 		break;
 	case TS_EPOCH:
-		printf("%s                                               |       <-      | |       ->      | |     Total     |       Relative       |   Duration   |\n",
-			display_ports ? "            " : "");
-		printf("%s                                               | Frames  Bytes | | Frames  Bytes | | Frames  Bytes |         Start        |              |\n",
-			display_ports ? "            " : "");
+		printf("%s                                               |       <-      | |       ->      | |     Total     |       Relative       |   Duration   |%s\n",
+			display_ports ? "            " : "", error_header1);
+		printf("%s                                               | Frames  Bytes | | Frames  Bytes | | Frames  Bytes |         Start        |              |%s\n",
+			display_ports ? "            " : "", error_header2);
 		break;
 	case TS_RELATIVE:
 	case TS_NOT_SET:
 	default:
-		printf("%s                                               |       <-      | |       ->      | |     Total     |    Relative    |   Duration   |\n",
-			display_ports ? "            " : "");
-		printf("%s                                               | Frames  Bytes | | Frames  Bytes | | Frames  Bytes |      Start     |              |\n",
-			display_ports ? "            " : "");
+		printf("%s                                               |       <-      | |       ->      | |     Total     |    Relative    |   Duration   |%s\n",
+			display_ports ? "            " : "", error_header1);
+		printf("%s                                               | Frames  Bytes | | Frames  Bytes | | Frames  Bytes |      Start     |              |%s\n",
+			display_ports ? "            " : "", error_header2);
 		break;
 	}
 
@@ -223,8 +228,13 @@ iousers_draw(void *arg)
 						nstime_to_sec(&iui->start_time));
 					break;
 				}
-				printf("   %12.4f\n",
+				printf("   %12.4f",
 					 nstime_to_sec(&iui->stop_time) - nstime_to_sec(&iui->start_time));
+				if (iu->hash.max_entries) {
+					/* As wide as the "    Error    |" header */
+					printf("  %12" PRIu64, iui->frames_error);
+				}
+				printf("\n");
 			}
 		}
 		max_frames = last_frames;
@@ -236,11 +246,18 @@ void init_iousers(struct register_ct *ct, const char *filter)
 {
 	io_users_t *iu;
 	GString *error_string;
+	unsigned max_entries;
+
+	if (!conversation_table_parse_topk(filter, &max_entries, &filter)) {
+		cmdarg_err("Invalid \"topk=\" value for conversations tap: %s", filter);
+		exit(1);
+	}
 
 	iu = g_new0(io_users_t, 1);
 	iu->type = proto_get_protocol_short_name(find_protocol_by_id(get_conversation_proto_id(ct)));
 	iu->filter = g_strdup(filter);
 	iu->hash.user_data = iu;
+	iu->hash.max_entries = max_entries;
 
 	error_string = register_tap_listener(proto_get_protocol_filter_name(get_conversation_proto_id(ct)), &iu->hash, filter, 0, NULL, get_conversation_packet_func(ct), iousers_draw, NULL);
 	if (error_string) {
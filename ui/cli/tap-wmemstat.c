@@ -0,0 +1,160 @@
+/* tap-wmemstat.c
+ * wmem allocation statistics for tshark
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/* This module reports, per memory scope, how much each protocol allocated
+ * with wmem. It is only used by tshark and not wireshark.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/packet_info.h>
+#include <epan/tap.h>
+#include <epan/stat_tap_ui.h>
+
+#include <wsutil/cmdarg_err.h>
+#include <wsutil/wmem/wmem.h>
+
+void register_tap_listener_wmemstat(void);
+
+static bool already_enabled;
+
+static tap_packet_status
+wmemstat_packet(void *arg _U_, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *dummy _U_, tap_flags_t flags _U_)
+{
+	/* The statistics are kept by wmem itself. */
+	return TAP_PACKET_DONT_REDRAW;
+}
+
+static void
+wmemstat_entry_free(void *data)
+{
+	wmem_tag_stats_t *stats = (wmem_tag_stats_t *)data;
+
+	g_free((char *)stats->scope);
+	g_free((char *)stats->tag);
+	g_free(stats);
+}
+
+/* The entries are only valid during the callback, so keep copies. */
+static void
+wmemstat_collect(const wmem_tag_stats_t *stats, void *user_data)
+{
+	wmem_tag_stats_t *copy = g_new(wmem_tag_stats_t, 1);
+
+	*copy = *stats;
+	copy->scope = g_strdup(stats->scope);
+	copy->tag = g_strdup(stats->tag);
+	g_ptr_array_add((GPtrArray *)user_data, copy);
+}
+
+/* Sort by scope, then by the most bytes allocated */
+static int
+wmemstat_compare(const void *a, const void *b)
+{
+	const wmem_tag_stats_t *sa = *(const wmem_tag_stats_t * const *)a;
+	const wmem_tag_stats_t *sb = *(const wmem_tag_stats_t * const *)b;
+	int ret;
+
+	ret = strcmp(sa->scope, sb->scope);
+	if (ret != 0)
+		return ret;
+	if (sa->bytes != sb->bytes)
+		return sa->bytes < sb->bytes ? 1 : -1;
+	if (sa->total_bytes != sb->total_bytes)
+		return sa->total_bytes < sb->total_bytes ? 1 : -1;
+	return strcmp(sa->tag, sb->tag);
+}
+
+static void
+wmemstat_draw(void *arg _U_)
+{
+	GPtrArray *entries = g_ptr_array_new_with_free_func(wmemstat_entry_free);
+	const char *scope = NULL;
+
+	wmem_foreach_tag_stats(wmemstat_collect, entries);
+	g_ptr_array_sort(entries, wmemstat_compare);
+
+	printf("\n");
+	printf("===================================================================================\n");
+	printf("wmem Statistics\n");
+	printf("Current: allocated since the scope was last freed; Total: since tshark started\n");
+	for (unsigned i = 0; i < entries->len; i++) {
+		const wmem_tag_stats_t *stats = (const wmem_tag_stats_t *)g_ptr_array_index(entries, i);
+
+		if (scope == NULL || strcmp(scope, stats->scope) != 0) {
+			scope = stats->scope;
+			printf("-----------------------------------------------------------------------------------\n");
+			printf("Scope: %s\n", scope);
+			printf("%-28s %12s %14s %12s %14s\n",
+			       "Protocol", "Cur. allocs", "Cur. bytes", "Tot. allocs", "Tot. bytes");
+		}
+		printf("%-28s %12" PRIu64 " %14" PRIu64 " %12" PRIu64 " %14" PRIu64 "\n",
+		       stats->tag, stats->allocations, stats->bytes,
+		       stats->total_allocations, stats->total_bytes);
+	}
+	printf("===================================================================================\n");
+
+	g_ptr_array_free(entries, TRUE);
+}
+
+static void
+wmemstat_init(const char *opt_arg _U_, void *userdata _U_)
+{
+	GString *error_string;
+
+	if (already_enabled) {
+		return;
+	}
+	already_enabled = true;
+
+	error_string = register_tap_listener("frame", NULL, NULL, 0, NULL, wmemstat_packet, wmemstat_draw, NULL);
+	if (error_string) {
+		cmdarg_err("Couldn't register wmem,stat tap: %s",
+			error_string->str);
+		g_string_free(error_string, TRUE);
+		exit(1);
+	}
+
+	wmem_set_statistics_enabled(true);
+}
+
+static stat_tap_ui wmemstat_ui = {
+	REGISTER_STAT_GROUP_GENERIC,
+	NULL,
+	"wmem,stat",
+	wmemstat_init,
+	0,
+	NULL
+};
+
+void
+register_tap_listener_wmemstat(void)
+{
+	register_stat_tap_ui(&wmemstat_ui, NULL);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -26,16 +26,34 @@
 static void
 depended_frames_add(GHashTable* depended_table, frame_data_sequence *frames, frame_data *frame)
 {
-    if (g_hash_table_add(depended_table, GUINT_TO_POINTER(frame->num)) && frame->dependent_frames) {
-        GHashTableIter iter;
-        void *key;
-        frame_data *depended_fd;
-        g_hash_table_iter_init(&iter, frame->dependent_frames);
-        while (g_hash_table_iter_next(&iter, &key, NULL)) {
-            depended_fd = frame_data_sequence_find(frames, GPOINTER_TO_UINT(key));
-            depended_frames_add(depended_table, frames, depended_fd);
+    const uint32_t *deps;
+    unsigned count;
+    GArray *pending;
+
+    if (!g_hash_table_add(depended_table, GUINT_TO_POINTER(frame->num))) {
+        return;
+    }
+    count = frame_data_get_dependencies(frame, &deps);
+    if (count == 0) {
+        return;
+    }
+
+    /* Use an explicit stack; dependency chains can be very long. */
+    pending = g_array_sized_new(false, false, sizeof(uint32_t), count);
+    g_array_append_vals(pending, deps, count);
+    while (pending->len > 0) {
+        uint32_t num = g_array_index(pending, uint32_t, pending->len - 1);
+
+        g_array_set_size(pending, pending->len - 1);
+        if (g_hash_table_add(depended_table, GUINT_TO_POINTER(num))) {
+            frame_data *depended_fd = frame_data_sequence_find(frames, num);
+            count = frame_data_get_dependencies(depended_fd, &deps);
+            if (count > 0) {
+                g_array_append_vals(pending, deps, count);
+            }
         }
     }
+    g_array_free(pending, true);
 }
 
 /* (re-)calculate the packet counts (except the user specified range) */
@@ -39,6 +39,8 @@ ATapDataModel::ATapDataModel(dataModelType type, int protoId, QString filter, QO
     hash_.conv_array = nullptr;
     hash_.hashtable = nullptr;
     hash_.user_data = this;
+    hash_.max_entries = 0;
+    hash_.topk = nullptr;
 
     storage_ = nullptr;
     _resolveNames = false;
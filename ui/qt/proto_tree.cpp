@@ -490,6 +490,9 @@ void ProtoTree::foreachTreeNode(proto_node *node, void *proto_tree_ptr)
 void ProtoTree::foreachExpand(const QModelIndex &index = QModelIndex()) {
 
     // Restore expanded state. (Note QModelIndex() refers to the root node)
+    // Collapsed subtrees are skipped, so that a huge tree isn't walked
+    // (and its model nodes created) just to be hidden; syncExpanded does
+    // the same for them when they are expanded.
     int children = proto_tree_model_->rowCount(index);
     QModelIndex childIndex;
     for (int child = 0; child < children; child++) {
@@ -498,9 +501,9 @@ void ProtoTree::foreachExpand(const QModelIndex &index = QModelIndex()) {
             ProtoNode *node = proto_tree_model_->protoNodeFromIndex(childIndex);
             if (node && node->isValid() && tree_expanded(node->protoNode()->finfo->tree_type)) {
                 expand(childIndex);
+                // We recurse here, but we're limited by tree depth checks in epan
+                foreachExpand(childIndex);
             }
-            // We recurse here, but we're limited by tree depth checks in epan
-            foreachExpand(childIndex);
         }
     }
 }
@@ -583,6 +586,10 @@ void ProtoTree::syncExpanded(const QModelIndex &index) {
     if (finfo.treeType() != -1) {
         tree_expanded_set(finfo.treeType(), true);
     }
+
+    disconnect(this, SIGNAL(expanded(QModelIndex)), this, SLOT(syncExpanded(QModelIndex)));
+    foreachExpand(index);
+    connect(this, SIGNAL(expanded(QModelIndex)), this, SLOT(syncExpanded(QModelIndex)));
 }
 
 void ProtoTree::syncCollapsed(const QModelIndex &index) {
@@ -23,6 +23,7 @@
 #ifdef QT_MULTIMEDIA_LIB
 
 #include <epan/dissectors/packet-rtp.h>
+#include <epan/rtp_pt.h>
 #include <epan/to_str.h>
 
 #include <wsutil/report_message.h>
@@ -48,6 +49,7 @@
 #include <QAudioDeviceInfo>
 #endif
 #include <QFrame>
+#include <QtConcurrent>
 #include <QMenu>
 #include <QVBoxLayout>
 #include <QTimer>
@@ -494,11 +496,13 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
     QAudioDeviceInfo cur_out_device = getCurrentDeviceInfo();
 #endif
     int row_count = ui->streamTreeWidget->topLevelItemCount();
+    QList<RtpAudioStream *> audio_streams;
 
     // Reset stream values
     for (int row = 0; row < row_count; row++) {
         QTreeWidgetItem *ti = ui->streamTreeWidget->topLevelItem(row);
         RtpAudioStream *audio_stream = ti->data(stream_data_col_, Qt::UserRole).value<RtpAudioStream*>();
+        audio_streams << audio_stream;
         audio_stream->setStereoRequired(stereo_available_);
         audio_stream->reset(first_stream_rel_start_time_);
 
@@ -516,12 +520,17 @@ void RtpPlayerDialog::rescanPackets(bool rescale_axes)
             break;
         }
         audio_stream->setTimingMode(timing_mode);
-
-	       //if (!cur_out_device.isNull()) {
-            audio_stream->decode(cur_out_device);
-        //}
     }
 
+    // Each stream has its own decoders, resamplers and audio file, so
+    // decode them in parallel on the global thread pool. The payload type
+    // names are looked up while decoding, and value_string_ext tables
+    // initialize themselves on first use, so do that here first.
+    try_val_to_str_ext(0, &rtp_payload_type_short_vals_ext);
+    QtConcurrent::blockingMap(audio_streams, [cur_out_device](RtpAudioStream *audio_stream) {
+        audio_stream->decode(cur_out_device);
+    });
+
     for (int col = 0; col < ui->streamTreeWidget->columnCount() - 1; col++) {
         ui->streamTreeWidget->resizeColumnToContents(col);
     }
@@ -12,28 +12,27 @@
 
 #include <epan/prefs.h>
 
-// NOLINTNEXTLINE(misc-no-recursion)
 ProtoNode::ProtoNode(proto_node *node, ProtoNode *parent) :
-    node_(node), parent_(parent)
+    node_(node), children_loaded_(false), parent_(parent), row_(-1)
 {
-    if (node_) {
-
-        int num_children = 0;
-        for (proto_node *child = node_->first_child; child; child = child->next) {
-            if (!isHidden(child)) {
-                num_children++;
-            }
-        }
+}
 
-        m_children.reserve(num_children);
+void ProtoNode::loadChildren() const
+{
+    if (children_loaded_) {
+        return;
+    }
+    children_loaded_ = true;
+    if (!node_) {
+        return;
+    }
 
-        for (proto_node *child = node_->first_child; child; child = child->next) {
-            if (!isHidden(child)) {
-                // We recurse here, but we're limited by tree depth checks in epan
-                m_children.append(new ProtoNode(child, this));
-            }
+    for (proto_node *child = node_->first_child; child; child = child->next) {
+        if (!isHidden(child)) {
+            m_child_nodes.append(child);
         }
     }
+    m_children.fill(nullptr, m_child_nodes.size());
 }
 
 ProtoNode::~ProtoNode()
@@ -93,7 +92,8 @@ int ProtoNode::childrenCount() const
 {
     if (!node_) return 0;
 
-    return (int)m_children.count();
+    loadChildren();
+    return (int)m_child_nodes.count();
 }
 
 int ProtoNode::row()
@@ -102,7 +102,7 @@ int ProtoNode::row()
         return -1;
     }
 
-    return (int)parent_->m_children.indexOf(const_cast<ProtoNode*>(this));
+    return row_;
 }
 
 bool ProtoNode::isExpanded() const
@@ -120,15 +120,21 @@ proto_node * ProtoNode::protoNode() const
 
 ProtoNode* ProtoNode::child(int row)
 {
+    loadChildren();
     if (row < 0 || row >= m_children.size())
         return nullptr;
+    if (!m_children.at(row)) {
+        ProtoNode *child = new ProtoNode(m_child_nodes.at(row), this);
+        child->row_ = row;
+        m_children[row] = child;
+    }
     return m_children.at(row);
 }
 
 ProtoNode::ChildIterator ProtoNode::children() const
 {
-    /* XXX: Iterate over m_children instead?
-     * Somewhat faster as m_children already excludes any hidden items. */
+    /* XXX: Iterate over m_child_nodes instead?
+     * Somewhat faster as m_child_nodes already excludes any hidden items. */
     proto_node *child = node_->first_child;
     while (child && isHidden(child)) {
         child = child->next;
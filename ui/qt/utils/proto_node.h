@@ -54,9 +54,15 @@ public:
 
 private:
     proto_node * node_;
-    QVector<ProtoNode*>m_children;
+    // Children are wrapped when they are first asked for, so that selecting
+    // a packet with a huge tree only wraps what the view shows.
+    mutable QVector<proto_node*>m_child_nodes;
+    mutable QVector<ProtoNode*>m_children;
+    mutable bool children_loaded_;
     ProtoNode *parent_;
+    int row_;
     static bool isHidden(proto_node * node);
+    void loadChildren() const;
 };
 
 
@@ -388,18 +388,31 @@ parse_num(const char *str, int offset, uint32_t* num)
     return IMPORT_SUCCESS;
 }
 
+/* Values of hex digits, for decoding bytes without strtoul() */
+static const uint8_t hex_nibble[256] = {
+    ['0'] = 0, ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4,
+    ['5'] = 5, ['6'] = 6, ['7'] = 7, ['8'] = 8, ['9'] = 9,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15
+};
+
+/*
+ * Decode two hex digits. The scanner only produces T_BYTE tokens that
+ * start with two hex digits, so no validation is needed.
+ */
+static inline uint8_t
+hex_byte(const char *str)
+{
+    return (hex_nibble[(unsigned char)str[0]] << 4) | hex_nibble[(unsigned char)str[1]];
+}
+
 /*----------------------------------------------------------------------
  * Write this byte into current packet
  */
 static import_status_t
 write_byte(const char *str)
 {
-    uint32_t num;
-
-    if (parse_num(str, false, &num) != IMPORT_SUCCESS)
-        return IMPORT_FAILURE;
-
-    packet_buf[curr_offset] = (uint8_t) num;
+    packet_buf[curr_offset] = hex_byte(str);
     curr_offset++;
     if (curr_offset >= info_p->max_frame_length) /* packet full */
         if (start_new_packet(true) != IMPORT_SUCCESS)
@@ -1269,7 +1282,7 @@ parse_token(token_t token, char *str)
     int     line_size;
     int     i;
     char   *s2;
-    char    tmp_str[3];
+    char    tmp_str[2];
     char  **tokens;
 
     /*
@@ -1479,12 +1492,11 @@ parse_token(token_t token, char *str)
                 for (i = 0; i < (line_size+1)/4; i++) {
                     tmp_str[0] = pkt_lnstart[i*3];
                     tmp_str[1] = pkt_lnstart[i*3+1];
-                    tmp_str[2] = '\0';
                     /* it is a valid convertible string */
                     if (!g_ascii_isxdigit(tmp_str[0]) || !g_ascii_isxdigit(tmp_str[1])) {
                         break;
                     }
-                    s2[i] = (char)strtoul(tmp_str, (char **)NULL, 16);
+                    s2[i] = (char)hex_byte(tmp_str);
                     rollback++;
                     /* the 3rd entry is not a delimiter, so the possible byte pattern will not shown */
                     if (!(pkt_lnstart[i*3+2] == ' ')) {
@@ -1544,6 +1556,35 @@ parse_token(token_t token, char *str)
     return IMPORT_SUCCESS;
 }
 
+/*----------------------------------------------------------------------
+ * Parse a run of bytes (called from the scanner)
+ *
+ * Each byte is two hex digits followed by a space or tab, so this is the
+ * same as a T_BYTE token per byte. Hex dumps are mostly such runs, so
+ * once inside a packet the bytes are written straight into the packet
+ * instead of going through the state machine one at a time.
+ */
+import_status_t
+parse_bytes(char *str, size_t len)
+{
+    const char *end = str + len;
+    bool noisy = ws_log_get_level() >= LOG_LEVEL_NOISY;
+
+    while (str < end) {
+        if (!noisy && (state == READ_OFFSET || state == READ_BYTE)) {
+            state = READ_BYTE;
+            if (write_byte(str) != IMPORT_SUCCESS)
+                return IMPORT_FAILURE;
+        } else {
+            if (parse_token(T_BYTE, str) != IMPORT_SUCCESS)
+                return IMPORT_FAILURE;
+        }
+        str += 3;
+    }
+
+    return IMPORT_SUCCESS;
+}
+
 /*----------------------------------------------------------------------
  * Import a text file.
  */
@@ -17,6 +17,8 @@
 #ifndef __TEXT_IMPORT_SCANNER_H__
 #define __TEXT_IMPORT_SCANNER_H__
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -38,6 +40,8 @@ typedef enum {
 
 import_status_t parse_token(token_t token, char *str);
 
+import_status_t parse_bytes(char *str, size_t len);
+
 extern FILE *text_importin;
 
 import_status_t text_import_scan(FILE *input_file);
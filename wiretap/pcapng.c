@@ -1067,7 +1067,15 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
                        pcapng_opt_byte_order_e byte_order,
                        int *err, char **err_info)
 {
-    uint8_t *option_content; /* Allocate as large as the options block */
+    /*
+     * Most blocks, packet blocks in particular, have only a few short
+     * options; read those into a buffer on the stack rather than
+     * allocating one for every block. It's an array of uint32_t to
+     * keep it aligned on a 4-byte boundary.
+     */
+    uint32_t option_small_buf[64];
+    uint8_t *option_content; /* As large as the options block */
+    uint8_t *option_alloc = NULL;
     unsigned opt_bytes_remaining;
     const uint8_t *option_ptr;
     const pcapng_option_header_t *oh;
@@ -1080,25 +1088,31 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
         return true;
     }
 
-    /* Allocate enough memory to hold all options */
-    option_content = (uint8_t *)g_try_malloc(opt_cont_buf_len);
-    if (option_content == NULL) {
-        *err = ENOMEM;  /* we assume we're out of memory */
-        return false;
+    if (opt_cont_buf_len <= sizeof option_small_buf) {
+        option_content = (uint8_t *)option_small_buf;
+    } else {
+        /* Allocate enough memory to hold all options */
+        option_alloc = (uint8_t *)g_try_malloc(opt_cont_buf_len);
+        if (option_alloc == NULL) {
+            *err = ENOMEM;  /* we assume we're out of memory */
+            return false;
+        }
+        option_content = option_alloc;
     }
 
     /* Read all the options into the buffer */
     if (!wtap_read_bytes(fh, option_content, opt_cont_buf_len, err, err_info)) {
         ws_debug("failed to read options");
-        g_free(option_content);
+        g_free(option_alloc);
         return false;
     }
 
     /*
      * Now process them.
      * option_ptr starts out aligned on at least a 4-byte boundary, as
-     * that's what g_try_malloc() gives us, and each option is padded
-     * to a length that's a multiple of 4 bytes, so it remains aligned.
+     * that's what g_try_malloc() and the uint32_t array give us, and
+     * each option is padded to a length that's a multiple of 4 bytes,
+     * so it remains aligned.
      */
     option_ptr = &option_content[0];
     opt_bytes_remaining = opt_cont_buf_len;
@@ -1109,7 +1123,7 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
         if (sizeof (*oh) > opt_bytes_remaining) {
             *err = WTAP_ERR_BAD_FILE;
             *err_info = ws_strdup_printf("pcapng: Not enough data for option header");
-            g_free(option_content);
+            g_free(option_alloc);
             return false;
         }
         option_code = oh->option_code;
@@ -1138,6 +1152,7 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
             *err = WTAP_ERR_INTERNAL;
             *err_info = ws_strdup_printf("pcapng: invalid byte order %d passed to pcapng_process_options()",
                                         byte_order);
+            g_free(option_alloc);
             return false;
         }
         option_ptr += sizeof (*oh); /* 4 bytes, so it remains aligned */
@@ -1151,7 +1166,7 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
             *err = WTAP_ERR_BAD_FILE;
             *err_info = ws_strdup_printf("pcapng: Not enough data to handle option of length %u",
                                         option_length);
-            g_free(option_content);
+            g_free(option_alloc);
             return false;
         }
 
@@ -1176,7 +1191,7 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
                                                   option_ptr,
                                                   byte_order,
                                                   err, err_info)) {
-                    g_free(option_content);
+                    g_free(option_alloc);
                     return false;
                 }
                 break;
@@ -1186,14 +1201,14 @@ pcapng_process_options(FILE_T fh, wtapng_block_t *wblock,
                     !(*process_option)(wblock, (const section_info_t *)section_info, option_code,
                                        option_length, option_ptr,
                                        err, err_info)) {
-                    g_free(option_content);
+                    g_free(option_alloc);
                     return false;
                 }
         }
         option_ptr += rounded_option_length; /* multiple of 4 bytes, so it remains aligned */
         opt_bytes_remaining -= rounded_option_length;
     }
-    g_free(option_content);
+    g_free(option_alloc);
     return true;
 }
 
@@ -2141,7 +2156,12 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh,
     int pseudo_header_len;
     int fcslen;
 
-    wblock->block = wtap_block_create(WTAP_BLOCK_PACKET);
+    /*
+     * The block is only created if there are options; most packets
+     * don't have any, and the record is returned without a block, as
+     * is done for Simple Packet Blocks.
+     */
+    wblock->block = NULL;
 
     /* "(Enhanced) Packet Block" read fixed part */
     if (enhanced) {
@@ -2333,10 +2353,13 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh,
         (int)sizeof(pcapng_block_header_t) -
         block_read -    /* fixed and variable part, including padding */
         (int)sizeof(bh->block_total_length);
-    if (!pcapng_process_options(fh, wblock, section_info, opt_cont_buf_len,
-                                pcapng_process_packet_block_option,
-                                OPT_SECTION_BYTE_ORDER, err, err_info))
-        return false;
+    if (opt_cont_buf_len != 0) {
+        wblock->block = wtap_block_create(WTAP_BLOCK_PACKET);
+        if (!pcapng_process_options(fh, wblock, section_info, opt_cont_buf_len,
+                                    pcapng_process_packet_block_option,
+                                    OPT_SECTION_BYTE_ORDER, err, err_info))
+            return false;
+    }
 
     /*
      * Did we get a packet flags option?
@@ -2353,7 +2376,9 @@ pcapng_read_packet_block(FILE_T fh, pcapng_block_header_t *bh,
     /*
      * How about a drop_count option? If not, set it from other sources
      */
-    if (WTAP_OPTTYPE_SUCCESS != wtap_block_get_uint64_option_value(wblock->block, OPT_PKT_DROPCOUNT, &tmp64) && packet.drops_count != 0xFFFF) {
+    if (packet.drops_count != 0xFFFF && WTAP_OPTTYPE_SUCCESS != wtap_block_get_uint64_option_value(wblock->block, OPT_PKT_DROPCOUNT, &tmp64)) {
+        if (wblock->block == NULL)
+            wblock->block = wtap_block_create(WTAP_BLOCK_PACKET);
         wtap_block_add_uint64_option(wblock->block, OPT_PKT_DROPCOUNT, (uint64_t)packet.drops_count);
     }
 
@@ -2540,18 +2540,19 @@ file_needs_reopen(int fd, const char* filename)
 }
 
 bool
-write_file_binary_mode(const char *filename, const void *content, size_t content_len)
+write_file_binary_mode_err(const char *filename, const void *content, size_t content_len,
+                           int *err, bool *open_failed)
 {
     int fd;
     size_t bytes_left;
     unsigned int bytes_to_write;
     ssize_t bytes_written;
     const uint8_t *ptr;
-    int err;
 
     fd = ws_open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0644);
     if (fd == -1) {
-        report_open_failure(filename, errno, true);
+        *err = errno;
+        *open_failed = true;
         return false;
     }
 
@@ -2580,11 +2581,11 @@ write_file_binary_mode(const char *filename, const void *content, size_t content
         bytes_written = ws_write(fd, ptr, bytes_to_write);
         if (bytes_written <= 0) {
             if (bytes_written < 0) {
-                err = errno;
+                *err = errno;
             } else {
-                err = WTAP_ERR_SHORT_WRITE;
+                *err = WTAP_ERR_SHORT_WRITE;
             }
-            report_write_failure(filename, err);
+            *open_failed = false;
             ws_close(fd);
             return false;
         }
@@ -2596,6 +2597,23 @@ write_file_binary_mode(const char *filename, const void *content, size_t content
     return true;
 }
 
+bool
+write_file_binary_mode(const char *filename, const void *content, size_t content_len)
+{
+    int err;
+    bool open_failed;
+
+    if (!write_file_binary_mode_err(filename, content, content_len, &err, &open_failed)) {
+        if (open_failed) {
+            report_open_failure(filename, err, true);
+        } else {
+            report_write_failure(filename, err);
+        }
+        return false;
+    }
+    return true;
+}
+
 /*
  * Copy a file in binary mode, for those operating systems that care about
  * such things.  This should be OK for all files, even text files, as
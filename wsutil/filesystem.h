@@ -402,6 +402,15 @@ WS_DLL_PUBLIC bool file_needs_reopen(int fd, const char* filename);
 WS_DLL_PUBLIC bool write_file_binary_mode(const char *filename,
     const void *content, size_t content_len);
 
+/*
+ * Like write_file_binary_mode(), but doesn't report errors, so that it can
+ * be used from threads other than the main one. If a failure, *err is set
+ * to the error and *open_failed to whether the file couldn't be opened (as
+ * opposed to written).
+ */
+WS_DLL_PUBLIC bool write_file_binary_mode_err(const char *filename,
+    const void *content, size_t content_len, int *err, bool *open_failed);
+
 /*
  * Copy a file in binary mode, for those operating systems that care about
  * such things.  This should be OK for all files, even text files, as
@@ -719,25 +719,17 @@ escape_null(char c, char *p)
     return false;
 }
 
-static char *
-escape_string_len(wmem_allocator_t *alloc, const char *string, ssize_t len,
+static void
+escape_string_append(wmem_strbuf_t *buf, const char *string, ssize_t len,
                     bool (*escape_func)(char c, char *p), bool add_quotes,
                     char quote_char, bool double_quote)
 {
     char c, r;
-    wmem_strbuf_t *buf;
-    size_t alloc_size;
     ssize_t i;
 
     if (len < 0)
         len = strlen(string);
 
-    alloc_size = len;
-    if (add_quotes)
-        alloc_size += 2;
-
-    buf = wmem_strbuf_new_sized(alloc, alloc_size);
-
     if (add_quotes && quote_char != '\0')
         wmem_strbuf_append_c(buf, quote_char);
 
@@ -771,6 +763,25 @@ escape_string_len(wmem_allocator_t *alloc, const char *string, ssize_t len,
 
     if (add_quotes && quote_char != '\0')
         wmem_strbuf_append_c(buf, quote_char);
+}
+
+static char *
+escape_string_len(wmem_allocator_t *alloc, const char *string, ssize_t len,
+                    bool (*escape_func)(char c, char *p), bool add_quotes,
+                    char quote_char, bool double_quote)
+{
+    wmem_strbuf_t *buf;
+    size_t alloc_size;
+
+    if (len < 0)
+        len = strlen(string);
+
+    alloc_size = len;
+    if (add_quotes)
+        alloc_size += 2;
+
+    buf = wmem_strbuf_new_sized(alloc, alloc_size);
+    escape_string_append(buf, string, len, escape_func, add_quotes, quote_char, double_quote);
 
     return wmem_strbuf_finalize(buf);
 }
@@ -803,6 +814,14 @@ char *ws_escape_csv(wmem_allocator_t *alloc, const char *string, bool add_quotes
         return escape_string_len(alloc, string, -1, escape_null, add_quotes, quote_char, double_quote);
 }
 
+void ws_escape_csv_append(wmem_strbuf_t *buf, const char *string, bool add_quotes, char quote_char, bool double_quote, bool escape_whitespace)
+{
+    if (escape_whitespace)
+        escape_string_append(buf, string, -1, escape_char, add_quotes, quote_char, double_quote);
+    else
+        escape_string_append(buf, string, -1, escape_null, add_quotes, quote_char, double_quote);
+}
+
 const char *
 ws_strerrorname_r(int errnum, char *buf, size_t buf_size)
 {
@@ -225,6 +225,11 @@ char *ws_escape_null(wmem_allocator_t *alloc, const char *string, size_t len, bo
 WS_DLL_PUBLIC
 char *ws_escape_csv(wmem_allocator_t *alloc, const char *string, bool add_quotes, char quote_char, bool double_quote, bool escape_whitespace);
 
+/* Like ws_escape_csv(), but appends the escaped string to an existing
+ * buffer instead of allocating a new one. */
+WS_DLL_PUBLIC
+void ws_escape_csv_append(wmem_strbuf_t *buf, const char *string, bool add_quotes, char quote_char, bool double_quote, bool escape_whitespace);
+
 WS_DLL_PUBLIC
 int ws_xton(char ch);
 
@@ -130,6 +130,11 @@ static void test_escape_string(void)
     buf = ws_escape_csv(NULL, "CSV-style \" escape", true, '"', true, false);
     g_assert_cmpstr(buf, ==, "\"CSV-style \"\" escape\"");
     wmem_free(NULL, buf);
+
+    wmem_strbuf_t *strbuf = wmem_strbuf_new(NULL, "a,");
+    ws_escape_csv_append(strbuf, "tab\tand,comma", false, ',', false, true);
+    g_assert_cmpstr(wmem_strbuf_get_str(strbuf), ==, "a,tab\\tand\\,comma");
+    wmem_strbuf_destroy(strbuf);
 }
 
 static void test_strconcat(void)
@@ -21,6 +21,7 @@ extern "C" {
 #endif /* __cplusplus */
 
 struct _wmem_user_cb_container_t;
+struct _wmem_scope_stats_t;
 
 /* See section "4. Internal Design" of doc/README.wmem for details
  * on this structure */
@@ -42,6 +43,10 @@ struct _wmem_allocator_t {
     void                        *private_data;
     enum _wmem_allocator_type_t  type;
     bool                         in_scope;
+
+    /* Allocation statistics, only kept for named allocators */
+    const char                  *name;
+    struct _wmem_scope_stats_t  *stats;
 };
 
 #ifdef __cplusplus
@@ -28,6 +28,174 @@
 static bool do_override;
 static wmem_allocator_type_t override_type;
 
+/* Allocation statistics of named pools, see wmem_set_statistics_enabled.
+ * Each pool counts into its own wmem_scope_stats_t, so freeing one pool
+ * never resets the counts of another pool with the same name; the counts
+ * of pools with the same name are only added up when they are reported.
+ * stats_mutex protects the list of live pool statistics, their counts
+ * (which are read when reporting while other threads may be allocating)
+ * and the totals of destroyed pools. It is only taken when statistics
+ * are enabled. */
+typedef struct _wmem_scope_stats_t {
+    const char *name;
+    GHashTable *tags;       /* tag -> wmem_tag_stats_t */
+} wmem_scope_stats_t;
+
+static bool stats_enabled;
+static wmem_tag_func_t stats_tag_func;
+static GMutex stats_mutex;
+static GSList *live_stats;          /* wmem_scope_stats_t of live pools */
+static GHashTable *retired_stats;   /* name -> wmem_scope_stats_t */
+
+static wmem_scope_stats_t *
+wmem_scope_stats_new(const char *name)
+{
+    wmem_scope_stats_t *stats;
+
+    stats = g_new(wmem_scope_stats_t, 1);
+    stats->name = g_strdup(name);
+    stats->tags = g_hash_table_new_full(g_str_hash, g_str_equal,
+            g_free, g_free);
+
+    return stats;
+}
+
+static void
+wmem_scope_stats_free(void *data)
+{
+    wmem_scope_stats_t *stats = (wmem_scope_stats_t *)data;
+
+    g_hash_table_destroy(stats->tags);
+    g_free((char *)stats->name);
+    g_free(stats);
+}
+
+static wmem_tag_stats_t *
+wmem_scope_stats_tag(wmem_scope_stats_t *stats, const char *tag)
+{
+    wmem_tag_stats_t *tag_stats;
+
+    tag_stats = (wmem_tag_stats_t *)g_hash_table_lookup(stats->tags, tag);
+    if (tag_stats == NULL) {
+        /* Copy the tag; protocol names can go away when plugins are
+         * reloaded. */
+        char *key = g_strdup(tag);
+
+        tag_stats = g_new0(wmem_tag_stats_t, 1);
+        tag_stats->scope = stats->name;
+        tag_stats->tag   = key;
+        g_hash_table_insert(stats->tags, key, tag_stats);
+    }
+
+    return tag_stats;
+}
+
+/* Adds the counts of stats to the entry with the same name in by_name.
+ * The counts since the pool was last freed are only added for live pools.
+ * Called with stats_mutex held. */
+static void
+wmem_scope_stats_merge(GHashTable *by_name, const wmem_scope_stats_t *stats,
+        bool live)
+{
+    wmem_scope_stats_t *merged;
+    GHashTableIter      iter;
+    wmem_tag_stats_t   *tag_stats, *merged_tag;
+
+    merged = (wmem_scope_stats_t *)g_hash_table_lookup(by_name, stats->name);
+    if (merged == NULL) {
+        merged = wmem_scope_stats_new(stats->name);
+        g_hash_table_insert(by_name, (char *)merged->name, merged);
+    }
+
+    g_hash_table_iter_init(&iter, stats->tags);
+    while (g_hash_table_iter_next(&iter, NULL, (void **)&tag_stats)) {
+        merged_tag = wmem_scope_stats_tag(merged, tag_stats->tag);
+        if (live) {
+            merged_tag->allocations += tag_stats->allocations;
+            merged_tag->bytes       += tag_stats->bytes;
+        }
+        merged_tag->total_allocations += tag_stats->total_allocations;
+        merged_tag->total_bytes       += tag_stats->total_bytes;
+    }
+}
+
+static void
+wmem_attach_scope_stats(wmem_allocator_t *allocator)
+{
+    allocator->stats = wmem_scope_stats_new(allocator->name);
+
+    g_mutex_lock(&stats_mutex);
+    live_stats = g_slist_prepend(live_stats, allocator->stats);
+    g_mutex_unlock(&stats_mutex);
+}
+
+/* Keeps the totals of a pool that is destroyed or renamed, so that they
+ * are still reported (e.g. for the pinfo pool, which is recreated). */
+static void
+wmem_detach_scope_stats(wmem_allocator_t *allocator)
+{
+    if (allocator->stats == NULL) {
+        return;
+    }
+
+    g_mutex_lock(&stats_mutex);
+    live_stats = g_slist_remove(live_stats, allocator->stats);
+    if (retired_stats == NULL) {
+        retired_stats = g_hash_table_new_full(g_str_hash, g_str_equal,
+                NULL, wmem_scope_stats_free);
+    }
+    wmem_scope_stats_merge(retired_stats, allocator->stats, false);
+    g_mutex_unlock(&stats_mutex);
+
+    wmem_scope_stats_free(allocator->stats);
+    allocator->stats = NULL;
+}
+
+static void
+wmem_record_alloc(wmem_allocator_t *allocator, const size_t size)
+{
+    wmem_tag_stats_t *tag_stats;
+    const char       *tag = NULL;
+
+    if (allocator->name == NULL) {
+        return;
+    }
+
+    if (allocator->stats == NULL) {
+        wmem_attach_scope_stats(allocator);
+    }
+
+    if (stats_tag_func) {
+        tag = stats_tag_func();
+    }
+    if (tag == NULL) {
+        tag = "(none)";
+    }
+
+    g_mutex_lock(&stats_mutex);
+    tag_stats = wmem_scope_stats_tag(allocator->stats, tag);
+    tag_stats->allocations++;
+    tag_stats->bytes += size;
+    tag_stats->total_allocations++;
+    tag_stats->total_bytes += size;
+    g_mutex_unlock(&stats_mutex);
+}
+
+static void
+wmem_reset_scope_stats(wmem_allocator_t *allocator)
+{
+    GHashTableIter    iter;
+    wmem_tag_stats_t *tag_stats;
+
+    g_mutex_lock(&stats_mutex);
+    g_hash_table_iter_init(&iter, allocator->stats->tags);
+    while (g_hash_table_iter_next(&iter, NULL, (void **)&tag_stats)) {
+        tag_stats->allocations = 0;
+        tag_stats->bytes = 0;
+    }
+    g_mutex_unlock(&stats_mutex);
+}
+
 void *
 wmem_alloc(wmem_allocator_t *allocator, const size_t size)
 {
@@ -41,6 +209,10 @@ wmem_alloc(wmem_allocator_t *allocator, const size_t size)
         return NULL;
     }
 
+    if (G_UNLIKELY(stats_enabled)) {
+        wmem_record_alloc(allocator, size);
+    }
+
     return allocator->walloc(allocator->private_data, size);
 }
 
@@ -93,6 +265,10 @@ wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 
     ws_assert(allocator->in_scope);
 
+    if (G_UNLIKELY(stats_enabled)) {
+        wmem_record_alloc(allocator, size);
+    }
+
     return allocator->wrealloc(allocator->private_data, ptr, size);
 }
 
@@ -102,6 +278,10 @@ wmem_free_all_real(wmem_allocator_t *allocator, bool final)
     wmem_call_callbacks(allocator,
             final ? WMEM_CB_DESTROY_EVENT : WMEM_CB_FREE_EVENT);
     allocator->free_all(allocator->private_data);
+
+    if (allocator->stats) {
+        wmem_reset_scope_stats(allocator);
+    }
 }
 
 void
@@ -121,6 +301,7 @@ wmem_destroy_allocator(wmem_allocator_t *allocator)
 {
 
     wmem_free_all_real(allocator, true);
+    wmem_detach_scope_stats(allocator);
     allocator->cleanup(allocator->private_data);
     wmem_free(NULL, allocator);
 }
@@ -142,6 +323,8 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     allocator->type      = real_type;
     allocator->callbacks = NULL;
     allocator->in_scope  = true;
+    allocator->name      = NULL;
+    allocator->stats     = NULL;
 
     switch (real_type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -198,12 +381,27 @@ wmem_init(void)
         }
     }
 
+    if (getenv("WIRESHARK_DEBUG_WMEM_STATS") != NULL) {
+        stats_enabled = true;
+    }
+
     wmem_init_hashing();
 }
 
 void
 wmem_cleanup(void)
 {
+    stats_enabled = false;
+    stats_tag_func = NULL;
+
+    /* Pools that are still alive keep their statistics and report them
+     * again if they are used after wmem_init(). */
+    g_mutex_lock(&stats_mutex);
+    if (retired_stats) {
+        g_hash_table_destroy(retired_stats);
+        retired_stats = NULL;
+    }
+    g_mutex_unlock(&stats_mutex);
 }
 
 void
@@ -225,6 +423,66 @@ wmem_in_scope(wmem_allocator_t *allocator)
     return allocator->in_scope;
 }
 
+void
+wmem_allocator_set_name(wmem_allocator_t *allocator, const char *name)
+{
+    wmem_detach_scope_stats(allocator);
+    allocator->name = name;
+}
+
+void
+wmem_set_statistics_enabled(bool enabled)
+{
+    stats_enabled = enabled;
+}
+
+bool
+wmem_statistics_enabled(void)
+{
+    return stats_enabled;
+}
+
+void
+wmem_set_tag_func(wmem_tag_func_t func)
+{
+    stats_tag_func = func;
+}
+
+void
+wmem_foreach_tag_stats(wmem_tag_stats_func_t func, void *user_data)
+{
+    GHashTable         *by_name;
+    GHashTableIter      scope_iter, tag_iter;
+    GHashTableIter      retired_iter;
+    wmem_scope_stats_t *stats;
+    wmem_tag_stats_t   *tag_stats;
+
+    by_name = g_hash_table_new_full(g_str_hash, g_str_equal,
+            NULL, wmem_scope_stats_free);
+
+    g_mutex_lock(&stats_mutex);
+    if (retired_stats) {
+        g_hash_table_iter_init(&retired_iter, retired_stats);
+        while (g_hash_table_iter_next(&retired_iter, NULL, (void **)&stats)) {
+            wmem_scope_stats_merge(by_name, stats, false);
+        }
+    }
+    for (GSList *item = live_stats; item; item = item->next) {
+        wmem_scope_stats_merge(by_name, (wmem_scope_stats_t *)item->data, true);
+    }
+    g_mutex_unlock(&stats_mutex);
+
+    g_hash_table_iter_init(&scope_iter, by_name);
+    while (g_hash_table_iter_next(&scope_iter, NULL, (void **)&stats)) {
+        g_hash_table_iter_init(&tag_iter, stats->tags);
+        while (g_hash_table_iter_next(&tag_iter, NULL, (void **)&tag_stats)) {
+            func(tag_stats, user_data);
+        }
+    }
+
+    g_hash_table_destroy(by_name);
+}
+
 
 /*
  * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
@@ -232,6 +232,76 @@ WS_DLL_PUBLIC
 bool
 wmem_in_scope(wmem_allocator_t *allocator);
 
+/** Allocation statistics for one tag in one named pool. The counts are of
+ * requested sizes, not including allocator overhead. Individual calls to
+ * wmem_free() are not subtracted, and wmem_realloc() counts as a new
+ * allocation of the new size.
+ */
+typedef struct _wmem_tag_stats_t {
+    const char *scope;          /**< The name of the pool(s). */
+    const char *tag;            /**< The tag, usually a protocol name. */
+    uint64_t allocations;       /**< Allocations since the pool was last freed. */
+    uint64_t bytes;             /**< Bytes allocated since the pool was last freed. */
+    uint64_t total_allocations; /**< Allocations since statistics were enabled. */
+    uint64_t total_bytes;       /**< Bytes allocated since statistics were enabled. */
+} wmem_tag_stats_t;
+
+/** Returns the tag to attribute the current allocation to, or NULL. */
+typedef const char *(*wmem_tag_func_t)(void);
+
+/** Called for each entry by wmem_foreach_tag_stats(). */
+typedef void (*wmem_tag_stats_func_t)(const wmem_tag_stats_t *stats, void *user_data);
+
+/** Names a pool, so that allocations in it are counted when statistics are
+ * enabled. Each pool keeps its own counts, and freeing a pool only resets
+ * its own counts. The counts of pools with the same name are added up when
+ * they are reported, including the totals of pools that were destroyed,
+ * which lets a pool that is recreated (like the pinfo pool) be tracked.
+ *
+ * @param allocator The allocator to name.
+ * @param name A static string naming the pool, e.g. "file".
+ */
+WS_DLL_PUBLIC
+void
+wmem_allocator_set_name(wmem_allocator_t *allocator, const char *name);
+
+/** Enables or disables counting allocations in named pools. This can also
+ * be enabled with the WIRESHARK_DEBUG_WMEM_STATS environment variable. When
+ * disabled the only cost is one test per allocation. This and
+ * wmem_set_tag_func() should be called before other threads use pools.
+ *
+ * @param enabled Whether to count allocations.
+ */
+WS_DLL_PUBLIC
+void
+wmem_set_statistics_enabled(bool enabled);
+
+WS_DLL_PUBLIC
+bool
+wmem_statistics_enabled(void);
+
+/** Sets the function that tags each allocation, typically with the name of
+ * the protocol being dissected. Allocations are tagged "(none)" if there is
+ * no function or it returns NULL.
+ *
+ * @param func The function to call for each counted allocation.
+ */
+WS_DLL_PUBLIC
+void
+wmem_set_tag_func(wmem_tag_func_t func);
+
+/** Calls func for the statistics of each tag in each pool name, in no
+ * particular order. The statistics passed to func, including the strings,
+ * are only valid during the call. It can be called while other threads
+ * allocate from named pools.
+ *
+ * @param func The function to call.
+ * @param user_data Passed to func.
+ */
+WS_DLL_PUBLIC
+void
+wmem_foreach_tag_stats(wmem_tag_stats_func_t func, void *user_data);
+
 /** @} */
 
 #ifdef __cplusplus
@@ -194,6 +194,131 @@ wmem_test_allocator_callbacks(void)
     g_assert_true(cb_called_count == 3);
 }
 
+static const char *stats_test_tag;
+
+static const char *
+wmem_test_stats_tag(void)
+{
+    return stats_test_tag;
+}
+
+static void
+wmem_test_stats_find(const wmem_tag_stats_t *stats, void *user_data)
+{
+    wmem_tag_stats_t *found = (wmem_tag_stats_t *)user_data;
+
+    if (strcmp(stats->scope, found->scope) == 0 &&
+            strcmp(stats->tag, found->tag) == 0) {
+        *found = *stats;
+    }
+}
+
+static void
+wmem_test_allocator_stats(void)
+{
+    wmem_allocator_t *allocator, *unnamed;
+    wmem_tag_stats_t  found;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    unnamed   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    wmem_allocator_set_name(allocator, "stats-test");
+
+    /* Nothing is counted while disabled */
+    wmem_alloc(allocator, 8);
+
+    wmem_set_statistics_enabled(true);
+    wmem_set_tag_func(wmem_test_stats_tag);
+
+    stats_test_tag = "proto-a";
+    wmem_alloc(allocator, 10);
+    wmem_alloc(allocator, 20);
+    wmem_alloc(unnamed, 40);
+    stats_test_tag = "proto-b";
+    wmem_alloc(allocator, 100);
+    stats_test_tag = NULL;
+    wmem_alloc(allocator, 1);
+
+    found = (wmem_tag_stats_t) { .scope = "stats-test", .tag = "proto-a" };
+    wmem_foreach_tag_stats(wmem_test_stats_find, &found);
+    g_assert_true(found.allocations == 2);
+    g_assert_true(found.bytes == 30);
+
+    found = (wmem_tag_stats_t) { .scope = "stats-test", .tag = "proto-b" };
+    wmem_foreach_tag_stats(wmem_test_stats_find, &found);
+    g_assert_true(found.allocations == 1);
+    g_assert_true(found.bytes == 100);
+
+    found = (wmem_tag_stats_t) { .scope = "stats-test", .tag = "(none)" };
+    wmem_foreach_tag_stats(wmem_test_stats_find, &found);
+    g_assert_true(found.allocations == 1);
+
+    /* Freeing the pool resets the current counts but not the totals */
+    wmem_free_all(allocator);
+    found = (wmem_tag_stats_t) { .scope = "stats-test", .tag = "proto-a" };
+    wmem_foreach_tag_stats(wmem_test_stats_find, &found);
+    g_assert_true(found.allocations == 0);
+    g_assert_true(found.bytes == 0);
+    g_assert_true(found.total_allocations == 2);
+    g_assert_true(found.total_bytes == 30);
+
+    wmem_set_statistics_enabled(false);
+    wmem_set_tag_func(NULL);
+    stats_test_tag = "proto-a";
+    wmem_alloc(allocator, 10);
+    found = (wmem_tag_stats_t) { .scope = "stats-test", .tag = "proto-a" };
+    wmem_foreach_tag_stats(wmem_test_stats_find, &found);
+    g_assert_true(found.total_allocations == 2);
+
+    wmem_destroy_allocator(unnamed);
+    wmem_destroy_allocator(allocator);
+}
+
+static void
+wmem_test_allocator_stats_shared_name(void)
+{
+    wmem_allocator_t *first, *second;
+    wmem_tag_stats_t  found;
+
+    first  = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    second = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+    wmem_allocator_set_name(first, "stats-shared");
+    wmem_allocator_set_name(second, "stats-shared");
+
+    wmem_set_statistics_enabled(true);
+    wmem_set_tag_func(wmem_test_stats_tag);
+    stats_test_tag = "proto-a";
+
+    wmem_alloc(first, 10);
+    wmem_alloc(second, 20);
+    wmem_alloc(second, 30);
+
+    /* The counts of pools with the same name are added up */
+    found = (wmem_tag_stats_t) { .scope = "stats-shared", .tag = "proto-a" };
+    wmem_foreach_tag_stats(wmem_test_stats_find, &found);
+    g_assert_true(found.allocations == 3);
+    g_assert_true(found.bytes == 60);
+
+    /* Freeing one pool does not reset the counts of the other */
+    wmem_free_all(first);
+    found = (wmem_tag_stats_t) { .scope = "stats-shared", .tag = "proto-a" };
+    wmem_foreach_tag_stats(wmem_test_stats_find, &found);
+    g_assert_true(found.allocations == 2);
+    g_assert_true(found.bytes == 50);
+    g_assert_true(found.total_bytes == 60);
+
+    /* The totals of a destroyed pool are kept */
+    wmem_destroy_allocator(second);
+    found = (wmem_tag_stats_t) { .scope = "stats-shared", .tag = "proto-a" };
+    wmem_foreach_tag_stats(wmem_test_stats_find, &found);
+    g_assert_true(found.allocations == 0);
+    g_assert_true(found.total_allocations == 3);
+    g_assert_true(found.total_bytes == 60);
+
+    wmem_set_statistics_enabled(false);
+    wmem_set_tag_func(NULL);
+    wmem_destroy_allocator(first);
+}
+
 static void
 wmem_test_allocator_det(wmem_allocator_t *allocator, wmem_verify_func verify,
         unsigned len)
@@ -1457,6 +1582,8 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/stats",     wmem_test_allocator_stats);
+    g_test_add_func("/wmem/allocator/stats_shared_name", wmem_test_allocator_stats_shared_name);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);